@@ -13,6 +13,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 #include <math.h>
 #include "phd.h"
 
@@ -67,6 +68,15 @@ public:
   };
 
 
+  /*
+   * Buffers for align_score, owned by the caller and reused across calls.
+   */
+  struct workspace {
+    vector<T> m;      // three rolling rows of the score matrix
+    vector<int> len;  // length of the alignment path ending at each cell
+  };
+
+
   aligner(const string fname, int const _debug = 0){
     sc = new phd<T>(fname);
     debug=_debug;
@@ -462,6 +472,98 @@ public:
 
   }
 
+
+  /*
+   * Computes only the score that align() would give in GLOBAL mode,
+   * without building the alignment. Only three rows of the matrix are
+   * kept, in the given workspace, so nothing is allocated once the
+   * workspace is large enough.
+   * The score is normalized by the length of the alignment found by
+   * align() when tracing back, so the length of the path each cell
+   * would be traced back through is computed along with the scores,
+   * checking the moves in the same order than the reconstruction step.
+   */
+  T align_score(const char* a, const int tj, const char* b, const int ti, workspace &ws){
+
+    if( ti==0 || tj == 0 ){ return 0; }
+
+    int const W = ti+1;
+    if( (int)ws.m.size() < 3*W ){ 
+      ws.m.resize(3*W); 
+      ws.len.resize(3*W); 
+    }
+    T* M = &ws.m[0];
+    int* L = &ws.len[0];
+    #define ROW(j) (((j)%3)*W)
+
+    int i,j;
+    int spacesA=0;
+    T best = -100000000;
+
+    // Row 0: start values are skips, and the path goes straight left.
+    M[0]=0; L[0]=0;
+    for(i=1; i<=ti; i++){ M[i] = M[i-1] + sc->dSkip(b[i-1]); L[i] = i; }
+
+    // column 1 is filled before the rest of the matrix in align(). Row 1
+    // later overwrites m[1][1], but column 1 keeps growing from the first value.
+    T col1 = M[1];
+    T m0 = 0;       // m[j][0]
+
+    for(j=1; j<=tj; j++){
+      T* cur  = M + ROW(j);
+      T* prev = M + ROW(j-1);
+      T* prev2 = (j>1 ? M + ROW(j-2) : NULL);
+      int* lcur  = L + ROW(j);
+      int* lprev = L + ROW(j-1);
+      int* lprev2 = (j>1 ? L + ROW(j-2) : NULL);
+
+      if(a[j-1]==' '|| a[j-1]=='_' ){spacesA++;}
+
+      T m0prev = m0;
+      m0 = m0 + sc->dSkip(a[j-1]);
+      cur[0] = m0;
+      lcur[0] = j;
+
+      col1 = max( m0prev+sc->dSub(a[j-1],b[0]) , col1+sc->dSkip(a[j-1]) );
+      if( best < col1 ){ best = col1; }
+
+      if( j==1 ){
+	for(i=1; i<=ti; i++){
+	  cur[i] = max( prev[i-1]+sc->dSub(a[0],b[i-1]) , cur[i-1]+sc->dSkip(b[i-1]) );
+	  if( best < cur[i] ){ best = cur[i]; }
+	}
+      } 
+      else {
+	cur[1] = col1;
+	for(i=2; i<=ti; i++){
+	  T i1 = prev[i-1] + sc->dSub(a[j-1],b[i-1]);
+	  T i2 = cur[i-1] + sc->dSkip(b[i-1]);
+	  T i3 = prev[i-2] + sc->dExp(a[j-1],b[i-2],b[i-1]);
+	  T i4 = prev[i] + sc->dSkip(a[j-1]);
+	  T i5 = prev2[i-1] + sc->dExp(b[i-1],a[j-2],a[j-1]);
+	  cur[i] = max((T)-10000000,max(i1,max(i2,max(i3,max(i4,i5)))));
+	  if( best < cur[i] ){ best = cur[i]; }
+	}
+      }
+
+      // path lengths, with the same move preference than the reconstruction
+      for(i=1; i<=ti; i++){
+	T v = cur[i];
+	if( v == prev[i-1] + sc->dSub(a[j-1],b[i-1]) )                       lcur[i] = lprev[i-1] + 1;
+	else if( v == cur[i-1] + sc->dSkip(b[i-1]) )                         lcur[i] = lcur[i-1] + 1;
+	else if( j>1 && v == prev2[i-1] + sc->dExp(b[i-1],a[j-2],a[j-1]) )  lcur[i] = lprev2[i-1] + 2;
+	else if( v == prev[i] + sc->dSkip(a[j-1]) )                          lcur[i] = lprev[i] + 1;
+	else if( i>1 && v == prev[i-2] + sc->dExp(a[j-1],b[i-2],b[i-1]) )   lcur[i] = lprev[i-2] + 2;
+	else lcur[i] = 0;  // reconstruction would stop here
+      }
+    }
+
+    int steps = L[ROW(tj)+ti] - spacesA;
+    #undef ROW
+
+    return (steps!=0 ? best/steps : best);
+  }
+
 };
 
 
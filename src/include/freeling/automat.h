@@ -30,11 +30,11 @@
 #define _AUTOMAT
 
 #include <set>
+#include <map>
+#include <vector>
 
 #include "fries/language.h"
-
-#define MAX_STATES 100
-#define MAX_TOKENS 50
+#include "regexp-pcre++.h"
 
 ////////////////////////////////////////////////////////////////
 ///
@@ -58,10 +58,14 @@
 ///
 ///   Child classes must provide a constructor that:
 ///     - fills the "final" set
-///     - fills the "trans" table
+///     - fills the "trans" table (transitions not given go to stopState)
 ///     - sets initialState and stopState
 ///     - initializes any other information required by the child
 ///
+///   The automaton description ("trans" and "Final") is compiled into
+///   a dense table sized to the actual number of states and tokens the
+///   first time the automaton is used.
+///
 ///   Child classes must provide the virtual functions:
 ///
 ///      - virtual int ComputeToken(int,sentence::iterator, sentence &);
@@ -105,16 +109,54 @@ class automat {
       /// Private function to re-arrange sentence when match found
       virtual sentence::iterator BuildMultiword(sentence &,sentence::iterator,sentence::iterator, int, bool &);
 
+      /// compiled transition table, ntokens entries per state.
+      std::vector<int> table;
+      /// size of compiled table
+      int nstates, ntokens;
+      /// final states, indexed by state code
+      std::vector<bool> final_states;
+      /// compile "trans" and "Final" descriptions into table and final_states
+      void compile();
+
  protected:
       /// state code of initial state
       int initialState;
       /// state code for stop State
       int stopState;
-      /// Transition tables
-      int trans[MAX_STATES][MAX_TOKENS];
-      /// set of final states
+      /// Transition table description: trans[state][token]=newstate.
+      /// Only used to describe the automaton, it is emptied when compiled.
+      std::map<int,std::map<int,int> > trans;
+      /// set of final states (emptied when compiled, as trans)
       std::set<int> Final;
 
+      /// get next state from compiled table
+      int next_state(int, int) const;
+
+      /// Classification of a word form, computed once per sentence and 
+      /// shared by all states and all match start positions.
+      class token_class {
+        public:
+          /// lowercased form
+          std::string lcform;
+          /// the form contains some digit
+          bool digit;
+          /// the form is made only of roman numeral letters (IVXLCDM)
+          bool roman;
+          /// regexes already checked on the form, and those matched (one bit each)
+          unsigned int checked, matched;
+      };
+      /// classification of the words in current sentence
+      std::map<const word*,token_class> classes;
+      /// get the classification of given word
+      token_class & classify(sentence::const_iterator);
+      /// check whether the form of the word matches the regex with the given bit,
+      /// (lowercased form or not, and optionally requiring a non-empty submatch)
+      bool check_regex(sentence::const_iterator, unsigned int, RegEx &, bool lc=true, int group=0);
+
+      /// move words from start to end (included) out of the sentence into a
+      /// list, building the multiword form. Return position after them.
+      sentence::iterator SpliceMultiword(sentence &, sentence::iterator, sentence::iterator, std::list<word> &, std::string &) const;
+
  public:
       /// Constructor
       automat();
@@ -127,5 +169,13 @@ class automat {
       bool annotate(sentence &, sentence::iterator &);
 };
 
+///////////////////////////////////////////////////////////////
+/// Get the state reached from state s with token t
+///////////////////////////////////////////////////////////////
+
+inline int automat::next_state(int s, int t) const {
+  return (t>=0 && t<ntokens ? table[s*ntokens+t] : stopState);
+}
+
 #endif
 
@@ -33,6 +33,7 @@
 
 #include "fries.h"
 #include "omlet.h"
+#include "freeling/compiled_adaboost.h"
 
 
 
@@ -53,15 +54,16 @@ class vis_viterbi {
     /// p_ini: vector with initial probabilities for each class
     std::vector<double> p_ini;
     /// p_trans: matrix with the probability transitions from one class to another
-    // e.g. P(B,B), P(O,B), etc
-    std::vector<std::vector<double> > p_trans;
+    // e.g. P(B,B), P(O,B), etc. P(j,i) is stored at p_trans[j*N+i]
+    std::vector<double> p_trans;
 
   public:
     /// Constructor: Create dynammic storage for the best path
     vis_viterbi (const std::string &);
 
     /// find_best_path: perform viterbi algortihm given the weights matrix
-    std::vector<int> find_best_path (double**, int) const;
+    /// (one row of N weights per word, stored contiguously)
+    std::vector<int> find_best_path (const double*, int) const;
 
 };
 
@@ -82,9 +84,17 @@ class bioner: public ner {
     /// lexicon to translate symbolic features to integer indexes
     std::map<std::string,int> lexicon;
     /// adaboost classifier
-    adaboost* classifier;
+    compiled_adaboost* classifier;
     /// viterbi class to compute best path
     vis_viterbi vit;
+    /// prediction matrix (one row per word), reused for each sentence
+    std::vector<double> all_pred;
+    /// features of all words in the sentence (those of word i are 
+    /// feat_ids[feat_offs[i]..feat_offs[i+1]-1]), reused for each sentence
+    std::vector<int> feat_offs;
+    std::vector<int> feat_ids;
+    /// classifier buffers, reused for each sentence
+    compiled_adaboost::workspace ws;
 
   public:
     /// Constructor
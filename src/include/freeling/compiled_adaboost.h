@@ -0,0 +1,123 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2004   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef _COMPILED_ADABOOST
+#define _COMPILED_ADABOOST
+
+#include <string>
+#include <vector>
+#include <set>
+
+////////////////////////////////////////////////////////////////
+///  Class compiled_adaboost loads an AdaBoost model (.abm file
+/// with decision tree weak rules, as written by omlet) and 
+/// classifies examples given as lists of active feature codes.
+///
+///  Trees are stored in flat arrays, and each feature points to 
+/// the trees that test it. The weights obtained when no feature 
+/// is active are precomputed, so classifying an example only 
+/// walks the trees that test some of its features.
+///
+///  The model is not modified after loading, so the same 
+/// instance may be used by several threads.
+////////////////////////////////////////////////////////////////
+
+class compiled_adaboost {
+   public:
+      /// Buffers used while classifying. Each thread needs its own.
+      class workspace {
+         public:
+            workspace();
+         private:
+            /// active features of current example (one per model feature)
+            std::vector<char> active;
+            /// trees visited for current example
+            std::vector<char> touched;
+            std::vector<int> trees;
+            /// features of current example, when given as a set
+            std::vector<int> feats;
+         friend class compiled_adaboost;
+      };
+
+      /// Constructor, loads given .abm file
+      compiled_adaboost(const std::string &);
+
+      /// number of labels
+      int get_nlabels() const;
+      /// name of i-th label
+      std::string get_label(int) const;
+      /// name of the <others> label, empty if none
+      std::string default_class() const;
+
+      /// compute weight of each label for example with given features.
+      /// Slow path: buffers are allocated at each call. Callers that
+      /// classify many examples should keep a workspace and use the
+      /// overloads below.
+      void classify(const std::set<int> &, double *) const;
+      void classify(const std::vector<int> &, double *) const;
+      /// same, reusing given buffers
+      void classify(const std::set<int> &, double *, workspace &) const;
+      void classify(const std::vector<int> &, double *, workspace &) const;
+      void classify(const int *, int, double *, workspace &) const;
+      /// classify n examples at once. Features of example i are 
+      /// feats[offs[i]..offs[i+1]-1], and its weights are written 
+      /// to pred[i*nlabels..(i+1)*nlabels-1]. The caller keeps the 
+      /// workspace, so its buffers are reused across batches.
+      void classify(int, const int *, const int *, double *, workspace &) const;
+
+   private:
+      /// label names and <others> label
+      std::vector<std::string> labels;
+      std::string others;
+      int nlabels;
+
+      /// model features (sorted) and trees testing each of them 
+      /// (trees of feature i are tree_ids[tree_offs[i]..tree_offs[i+1]-1])
+      std::vector<int> features;
+      std::vector<int> tree_offs;
+      std::vector<int> tree_ids;
+
+      /// tree nodes. For internal nodes, node_feat is the index in 'features'
+      /// of the tested feature, the subtree for the feature not present 
+      /// starts at next node, and node_next holds where the subtree for 
+      /// the feature present starts. For leaves, node_feat is -1 and 
+      /// node_next is the position of its weights in 'leaves'.
+      std::vector<int> node_feat;
+      std::vector<int> node_next;
+      std::vector<double> leaves;
+      /// root node of each tree, and leaf reached when no feature is present
+      std::vector<int> roots;
+      std::vector<int> absent_leaf;
+      /// sum of weights of all trees when no feature is present
+      std::vector<double> base;
+
+      int read_tree(std::istream &, std::vector<int> &, const std::string &);
+      int tree_leaf(int, const std::vector<char> &) const;
+};
+
+#endif
@@ -32,7 +32,7 @@
 #include <set>
 
 #include "fries.h"
-#include "omlet.h"
+#include "freeling/compiled_adaboost.h"
 #include "freeling/coref_fex.h"
 
 ////////////////////////////////////////////////////////////////
@@ -44,21 +44,44 @@ class coref {
 		/// feature extractor
 		coref_fex *extractor;
 		/// adaboost classifier
-		adaboost* classifier;
+		compiled_adaboost* classifier;
 		/// Max distance to search for a coreference node
 		int MaxDistance;
+		/// pair filters applied before classifying (COREFEX_FILTER_* flags)
+		int Filters;
 
-		bool check_coref(const SAMPLE & sa1, const SAMPLE & sa2) const;
+		bool check_coref(const SAMPLE & sa1, const SAMPLE & sa2, std::vector<int> & encoded, compiled_adaboost::workspace & ws) const;
 		void set_sample(parse_tree::iterator pt, SAMPLE & sample) const;
 		void add_candidates(int sent, int & word, parse_tree::iterator pt, list<SAMPLE> & candidates) const;
 
 	public:
+		/// Status kept between calls when a document is solved paragraph by paragraph
+		class state {
+			public:
+				state();
+				/// number of candidate noun phrases seen so far
+				int candidates() const;
+			private:
+				/// last candidates, the only ones that may corefer with the next ones
+				std::list<SAMPLE> window;
+				int sent;
+				int word;
+				int ncand;
+			friend class coref;
+		};
+
 		/// Constructor
 		coref();
 		coref(const std::string &, const int);
 
 		/// Classify SN's in given sentence in groups of coreference
 		void analyze(document &) const;
+		/// Same, for next paragraph of the document. Paragraph needs not be 
+		/// stored in the document, and may be output once MaxDistance
+		/// more candidates have been seen.
+		void analyze(paragraph &, document &, state &) const;
+		/// Maximum distance (in candidates) between coreferent noun phrases
+		int get_max_distance() const;
 };
 
 #endif
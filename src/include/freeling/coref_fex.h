@@ -22,14 +22,37 @@
 
 class SAMPLE {
  public:
+	SAMPLE();
 	int sent;
 	int numde;
 	int posbegin;
 	int posend;
 	node *node1;
+	/// id of node1, still valid after the tree is modified
+	std::string node_id;
 	std::string text;
 	std::vector<std::string> texttok;
 	std::vector<std::string> tags;
+
+	// Features depending only on this mention, filled by
+	// coref_fex::set_mention_features so that they are computed once
+	// and not for every pair the mention takes part in.
+
+	/// first tag after skipping prepositions, punctuation, etc.
+	unsigned int first;
+	/// number and gender of that tag ('0' if unknown)
+	char number;
+	char gender;
+	/// tokens used for string matching
+	std::string strkey;
+	/// semantic class as first and as second mention of a pair
+	std::string semclass1;
+	std::string semclass2;
+	/// head used for semclass2 is a personal pronoun
+	bool pp2;
+	/// active features of the mention as first and as second element of a pair
+	std::vector<int> feats1;
+	std::vector<int> feats2;
 };
 
 //////////////////////////////////////////////////////////////////
@@ -62,6 +85,9 @@ class EXAMPLE {
 #define COREFEX_ALIAS		0x00001000
 #define COREFEX_APPOS		0x00002000
 
+#define COREFEX_FILTER_NUMBER	0x00000001
+#define COREFEX_FILTER_GENDER	0x00000002
+
 //////////////////////////////////////////////////////////////////
 ///    Class for the feature extractor.
 //////////////////////////////////////////////////////////////////
@@ -74,49 +100,54 @@ class coref_fex{
 		int vectors;
 
 		int jump(const std::vector<std::string> &);
-		int get_dist(const EXAMPLE &);
-		int get_numdedist(const EXAMPLE &);
-		int get_dedist(const EXAMPLE &);
-		int get_i_pronoum(const EXAMPLE &);
-		int get_j_pronoum(const EXAMPLE &);
-		int get_i_pronoum_p(const EXAMPLE &);
-		int get_j_pronoum_p(const EXAMPLE &);
-		int get_i_pronoum_d(const EXAMPLE &);
-		int get_j_pronoum_d(const EXAMPLE &);
-		int get_i_pronoum_x(const EXAMPLE &);
-		int get_j_pronoum_x(const EXAMPLE &);
-		int get_i_pronoum_i(const EXAMPLE &);
-		int get_j_pronoum_i(const EXAMPLE &);
-		int get_i_pronoum_t(const EXAMPLE &);
-		int get_j_pronoum_t(const EXAMPLE &);
-		int get_i_pronoum_r(const EXAMPLE &);
-		int get_j_pronoum_r(const EXAMPLE &);
-		int get_i_pronoum_e(const EXAMPLE &);
-		int get_j_pronoum_e(const EXAMPLE &);
-		int get_str_match(const EXAMPLE &);
-		int get_def_np(const EXAMPLE &);
-		int get_dem_np(const EXAMPLE &);
-		int get_number(const EXAMPLE &);
-		int get_semclass(const EXAMPLE &);
-		int get_gender(const EXAMPLE &);
-		int get_proper_name(const EXAMPLE &);
-		bool check_word(string, string);
-		int check_acronim(const EXAMPLE &);
-		int check_fixesleft(const EXAMPLE &);
-		int check_fixesright(const EXAMPLE &);
-		int check_order(const EXAMPLE &);
-		int get_alias_acro(const EXAMPLE &);
-		int get_alias_fixleft(const EXAMPLE &);
-		int get_alias_fixright(const EXAMPLE &);
-		int get_alias_order(const EXAMPLE &);
-		int get_appositive(const EXAMPLE &);
-		int get_i_inquotes(const EXAMPLE &);
-		int get_j_inquotes(const EXAMPLE &);
-		int get_i_inparenthesis(const EXAMPLE &);
-		int get_j_inparenthesis(const EXAMPLE &);
-		int get_i_thirtperson(const EXAMPLE &);
-		int get_j_thirtperson(const EXAMPLE &);
+		int get_dist(int);
+		int get_numdedist(const SAMPLE &, const SAMPLE &);
+		int get_dedist(const SAMPLE &, const SAMPLE &);
+		int get_i_pronoum(const SAMPLE &);
+		int get_j_pronoum(const SAMPLE &);
+		int get_i_pronoum_p(const SAMPLE &);
+		int get_j_pronoum_p(const SAMPLE &);
+		int get_i_pronoum_d(const SAMPLE &);
+		int get_j_pronoum_d(const SAMPLE &);
+		int get_i_pronoum_x(const SAMPLE &);
+		int get_j_pronoum_x(const SAMPLE &);
+		int get_i_pronoum_i(const SAMPLE &);
+		int get_j_pronoum_i(const SAMPLE &);
+		int get_i_pronoum_t(const SAMPLE &);
+		int get_j_pronoum_t(const SAMPLE &);
+		int get_i_pronoum_r(const SAMPLE &);
+		int get_j_pronoum_r(const SAMPLE &);
+		int get_i_pronoum_e(const SAMPLE &);
+		int get_j_pronoum_e(const SAMPLE &);
+		std::string get_str_key(const SAMPLE &);
+		int get_str_match(const SAMPLE &, const SAMPLE &);
+		int get_def_np(const SAMPLE &);
+		int get_dem_np(const SAMPLE &);
+		char get_number_value(const SAMPLE &);
+		int get_number(const SAMPLE &, const SAMPLE &);
+		std::string get_semclass_type(const SAMPLE &, bool, bool &);
+		int get_semclass(const SAMPLE &, const SAMPLE &);
+		char get_gender_value(const SAMPLE &);
+		int get_gender(const SAMPLE &, const SAMPLE &);
+		int get_proper_name(const SAMPLE &, const SAMPLE &);
+		bool check_word(const std::string &, const std::string &);
+		int check_acronim(const SAMPLE &, const SAMPLE &);
+		int check_fixesleft(const SAMPLE &, const SAMPLE &);
+		int check_fixesright(const SAMPLE &, const SAMPLE &);
+		int check_order(const SAMPLE &, const SAMPLE &);
+		int get_alias_acro(const SAMPLE &, const SAMPLE &);
+		int get_alias_fixleft(const SAMPLE &, const SAMPLE &);
+		int get_alias_fixright(const SAMPLE &, const SAMPLE &);
+		int get_alias_order(const SAMPLE &, const SAMPLE &);
+		int get_appositive(const SAMPLE &, const SAMPLE &);
+		int get_i_inquotes(const SAMPLE &);
+		int get_j_inquotes(const SAMPLE &);
+		int get_i_inparenthesis(const SAMPLE &);
+		int get_j_inparenthesis(const SAMPLE &);
+		int get_i_thirtperson(const SAMPLE &);
+		int get_j_thirtperson(const SAMPLE &);
 
+		void extract(const SAMPLE &, const SAMPLE &, int, std::vector<int> &);
 		void put_feature(int, std::vector<int> &);
 	public:
 		int typeVector;
@@ -124,8 +155,16 @@ class coref_fex{
 		coref_fex(const int, const int, const std::string&, const std::string&);
 		coref_fex();
 		~coref_fex();
+		/// Active features. Mentions must be prepared again if changed.
 		void setVectors(int);
 		std::vector<std::string> tokenize(const std::string &, const std::string &);
+		/// Compute and store in the sample the features of a single mention
+		void set_mention_features(SAMPLE &);
+		/// Features of a pair of mentions, already prepared with set_mention_features
+		void extract(const SAMPLE &, const SAMPLE &, std::vector<int> &);
+		/// Same for an example, computing the features of both mentions
 		void extract(EXAMPLE &, std::vector<int> &);
+		/// Cheap check of number/gender agreement (COREFEX_FILTER_* flags)
+		bool compatible(const SAMPLE &, const SAMPLE &, int) const;
 };
 #endif
@@ -29,6 +29,8 @@
 #ifndef _CORRECTOR
 #define _CORRECTOR
 
+#include <set>
+#include <list>
 #include "fries/language.h"
 #include "freeling/database.h"
 #include "freeling/dictionary.h"
@@ -53,6 +55,13 @@ class corrector {
       
       /// indexed file with similar words
       database similar_words;
+      /// indexed file with deletion neighbourhoods of dictionary words (optional).
+      /// If given, candidates are taken from it instead of similar_words.
+      database deletions;
+      /// whether the deletion index is used to filter candidates
+      bool useDeletions;
+      /// maximum edit distance for candidates found in the deletion index
+      int MaxEditDistance;
 	
       /// The dictionary that FreeLing is currently using
       dictionary* dict; 
@@ -84,8 +93,10 @@ class corrector {
       bool noDictionaryCheck;
       /// returns the consonant key of a word
       std::string getKey(std::string);
+      /// returns the dictionary words within MaxEditDistance of a word
+      std::set<std::string> getNeighbours(const std::string &);
       /// adds the new words that are posible correct spellings from original word to the word analysys data
-      void putWords(std::string, word &);
+      void putWords(std::list<std::string> &, word &);
            
  public:
       /// Constructor
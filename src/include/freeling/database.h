@@ -31,6 +31,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #ifdef USE_LIBDB
 #include <db_cxx.h>  // header of BerkeleyDB C++ interface
@@ -64,6 +65,13 @@ class database {
     /// dictionary loaded into RAM (if no DB is used)
     std::map<std::string,std::string> dbmap;
 
+    /// Bloom filter over all keys (empty if not built)
+    std::vector<unsigned int> filter;
+    /// size of the filter in bits (a power of two), and number of hash functions
+    unsigned int filter_bits, filter_hashes;
+    /// compute the two base hashes of a key
+    static void hash_key(const std::string &, unsigned int &, unsigned int &);
+
   public:
     /// constructor
     database();
@@ -76,6 +84,11 @@ class database {
     void close_database();
     ///  search for a string key in the DB, return associated string data.
     std::string access_database(const std::string &);
+
+    /// build a Bloom filter over all keys, with at least given bits per key
+    void build_filter(unsigned int bits_per_key=10);
+    /// false if the key is surely not in the DB (true if no filter was built)
+    bool may_contain(const std::string &) const;
 };
 
 #endif
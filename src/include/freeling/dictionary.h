@@ -67,6 +67,8 @@ class dictionary {
 
       /// Get the analysis list from a given form 
       void search_form(const std::string &, std::list<analysis> &);
+      /// Quick check: false if the form is surely not in the dictionary
+      bool may_contain_form(const std::string &) const;
       /// Search words in sentence using default options
       void annotate(sentence &);
 };
@@ -3,24 +3,77 @@
 
 #include <string>
 #include <list>
+#include <deque>
 
 #include "fries/language.h"
 #include "freeling/semdb.h"
 
+namespace ukb {
+  class Kb;
+  class KbImage;
+  class WDict;
+  struct Kb_prank_params;
+  struct Kb_workspace;
+  class CSentence;
+  struct Kb_context_pv;
+}
+
 class disambiguator {
    public:
+      /// Buffers used by one call to analyze. Each thread calling
+      /// analyze concurrently on the same disambiguator needs its own.
+      class workspace {
+         public:
+            workspace();
+            ~workspace();
+            /// forget sentences kept as left context. Must be called at document
+            /// boundaries, or the first sentences of a document get as context
+            /// the last ones of the previous document.
+            void clear_context();
+         private:
+            ukb::Kb_workspace *ws;
+            /// last sentences seen, used as left context in window mode
+            std::deque<ukb::CSentence> *history;
+            /// personalization of the current window, updated as sentences enter and leave it
+            ukb::Kb_context_pv *context;
+            workspace(const workspace &);
+            workspace & operator=(const workspace &);
+         friend class disambiguator;
+      };
+
       /// Constructor
-      disambiguator(const std::string &, const std::string &, double, int);
+      disambiguator(const std::string &, const std::string &, double, int, int threads=1, double push=0.0, int warm=0, int stable=0, int window=0);
       /// Destructor
       ~disambiguator();
-      /// word sense disambiguation for each word in given sentences
+      /// word sense disambiguation for each word in given sentences. Uses a new
+      /// workspace at each call, so in window mode no context is kept between calls.
       void analyze(std::list<sentence> &) const;
+      /// same, using given workspace. May be called from several threads at once.
+      void analyze(std::list<sentence> &, workspace &) const;
       /// Return annotated copy (useful for perl/python/java APIs)
       std::list<sentence> analyze(const std::list<sentence> &) const;
       
    private:
+      /// knowledge base graph, with dictionary words added
+      ukb::Kb *kb;
+      /// word to synsets dictionary
+      ukb::WDict *dict;
+      /// memory mapped image of graph and dictionary, used instead of kb and dict if given
+      ukb::KbImage *img;
+      /// PageRank parameters
+      ukb::Kb_prank_params *params;
+      /// sentences of context at each side of the target sentence (0: whole list is one context)
+      int window;
+
+      /// disambiguate each sentence with a window of neighbour sentences as context
+      void analyze_window(std::list<sentence> &, workspace &) const;
+      /// copy ranks of given range of context words to the corresponding FreeLing words
+      void set_senses(ukb::CSentence &, size_t, size_t, std::list<sentence::iterator> &) const;
       ///removal of trailing -a, -n, -v, or -r from synset code
       std::string convert_synset(const std::string &) const;
+
+      disambiguator(const disambiguator &);
+      disambiguator & operator=(const disambiguator &);
 };
 
 #endif
@@ -32,6 +32,7 @@
 
 #include <map> 
 #include <set> 
+#include <vector> 
 
 #include "fries/language.h"
 #include "freeling/automat.h"
@@ -43,12 +44,20 @@
 
 class locutions: public automat {
    private:
-      /// store multiword list
-      std::map<std::string,std::string> locut;
-      /// store multiword prefixes
-      std::set<std::string> prefixes;
-      /// partially build multiword.
-      std::set<std::string> acc_mw,longest_mw;
+      /// node of the locution trie, over token symbols
+      class loc_node {
+        public:
+          /// children, by token symbol
+          std::map<int,int> next;
+          /// locution ending at this node (key and data), if any
+          std::string key, data;
+      };
+      /// trie storing all multiwords. Node 0 is the root
+      std::vector<loc_node> trie;
+      /// symbol codes for key components: forms and tags, and lemmas (<lemma>)
+      std::map<std::string,int> symbols, lemma_symbols;
+      /// trie nodes reached by partially build multiword.
+      std::set<int> acc_mw,longest_mw;
       /// store mw components in case we need to recover them
       std::vector<word> components;
       /// count words scanned beyond last longest mw found.
@@ -56,7 +65,10 @@ class locutions: public automat {
       /// analysis assigned to the mw by the validation step
       std::list<analysis> mw_analysis;
 
-      void check(const std::string, std::set<std::string> &, bool &, bool &);
+      /// get the symbol code for a key component, creating it if required
+      int get_symbol(const std::string &);
+      /// get the symbol path for a form/tag or a lemma (false if some symbol does not exist)
+      bool get_path(const std::string &, bool, std::vector<int> &) const;
       int ComputeToken(int, sentence::iterator &, sentence &);
       void ResetActions();
       void StateActions(int, int, int, sentence::const_iterator);
@@ -69,6 +69,8 @@ class maco {
       /// Destructor
       ~maco();
 
+      /// analyze given sentence
+      void analyze(sentence &);
       /// analyze given sentences
       void analyze(std::list<sentence> &);
       /// analyze sentences, return analyzed copy
@@ -33,6 +33,7 @@
 
 #include "fries.h"
 #include "omlet.h"
+#include "freeling/compiled_adaboost.h"
 
 ////////////////////////////////////////////////////////////////
 ///  The class nec implements a ML-based NE classificator
@@ -45,7 +46,7 @@ class nec {
      /// lexicon to translate symbolic features to integer indexes
      std::map<std::string,int> lexicon;
      /// adaboost classifier
-     adaboost* classifier;
+     compiled_adaboost* classifier;
      // tag of NPs to classify
      std::string NPtag;
 
@@ -46,6 +46,8 @@ class phoneticDistance {
 	
 	/// object that calculate the phonetic distance between toe words
 	aligner<int>* al;
+	/// buffers reused by the aligner across calls
+	aligner<int>::workspace ws;
 	
 
    public:
@@ -55,7 +57,7 @@ class phoneticDistance {
       ~phoneticDistance();
 
 	/// Returns the phonetic distance between two words
-	int getPhoneticDistance(string,string);
+	int getPhoneticDistance(const string &,const string &);
 
 
 };
@@ -32,6 +32,8 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <list>
+#include <pthread.h>
 #include "freeling/soundChange.h"
 
 using namespace std;
@@ -52,8 +54,17 @@ class phonetics {
 	bool useDict;
 	///variables and valor extracted from rule file for the translation
 	map<string, string> vars;
-	/// internal chace with phonetic translation of previous words
-	map<string, string> cache;
+	/// internal chace with phonetic translation of previous words,
+	/// and position of each word in cache_order
+	map<string, pair<string, list<string>::iterator> > cache;
+	/// cached words, least recently used first
+	list<string> cache_order;
+	/// maximum number of words in the cache (0 = no cache)
+	size_t cacheSize;
+	/// lock for the cache, which may be shared by several threads
+	pthread_mutex_t lock;
+	/// lock for the sound changer, which is not reentrant
+	pthread_mutex_t sc_lock;
 	/// rules extracted from the rule file
 	vector <string> rules;
 	/// translation rules from the sampa file
@@ -66,13 +77,13 @@ class phonetics {
 	
 
    public:
-      /// Constructor with language, rule file, dictFile, sampaFile, useDictFile
-      phonetics(string, string, string, bool);
+      /// Constructor with rule file, dictFile, sampaFile, useDictFile, and cache size
+      phonetics(string, string, string, bool, size_t cache=10000);
       /// Destructor
       ~phonetics();
 
 	/// Returns the phonetic sound of the word
-	string getSound(string);
+	string getSound(const string &);
 
 
 
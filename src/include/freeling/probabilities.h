@@ -30,6 +30,7 @@
 #define _PROBABILITIES
 
 #include <map>
+#include <vector>
 
 #include "fries/language.h"
 
@@ -56,16 +57,50 @@ class probabilities {
       /// Mass threshold to reduce count of analysis for an alternative
       double AlternativeAnalysisMass;
 
-      /// unigram probabilities
-      std::map<std::string,double> single_tags;
+      /// Tag distributions stored in flat arrays: distribution d holds 
+      /// the (tag id, probability) pairs in positions [offs[d],offs[d+1])
+      class distributions {
+        public:
+          std::vector<int> offs;
+          std::vector<int> tags;
+          std::vector<double> probs;
+
+          distributions();
+          /// add a distribution (tags without id are skipped), return its index
+          int add(const std::map<std::string,double> &, const std::map<std::string,int> &);
+          /// probability of given tag in distribution d (0 if not there)
+          double get(int, int) const;
+      };
+
+      /// short tags in the model, with their id. Ids follow string order.
+      std::map<std::string,int> tag_ids;
+      /// id of NP tag
+      int NP_id;
+      /// unigram probabilities, indexed by tag id
+      std::vector<double> single_tags;
+      /// usual ambiguity classes (sorted tag ids), and their distribution
+      std::map<std::vector<int>,int> class_ids;
       /// probabilities for usual ambiguity classes
-      std::map<std::string,std::map<std::string,double> > class_tags;
+      distributions class_tags;
+      /// frequent word forms, and their distribution
+      std::map<std::string,int> form_ids;
       /// lexical probabilities for frequent words 
-      std::map<std::string,std::map<std::string,double> > lexical_tags;
+      distributions lexical_tags;
       /// list of tags and probabilities to assign to unknown words
       std::map<std::string,double> unk_tags;
-      /// list of tag frequencies for unknown word suffixes
-      std::map<std::string,std::map<std::string,double> > unk_suffs;
+      /// short version of each tag in unk_tags, in the same order
+      std::vector<std::string> unk_short;
+      /// Tag frequencies for unknown word suffixes, in a trie of reversed
+      /// suffixes, so walking a word from its end visits all its suffixes.
+      /// Children of node n are in positions [suff_offs[n],suff_offs[n+1])
+      /// of suff_chars/suff_nodes, sorted by char. Node 0 is the root.
+      std::vector<int> suff_offs;
+      std::vector<char> suff_chars;
+      std::vector<int> suff_nodes;
+      /// whether the suffix ending at each node is in the model
+      std::vector<bool> suff_found;
+      /// probabilities of each suffix in the trie, by unk_tags position
+      distributions suff_probs;
       /// unknown words suffix smoothing parameter;
       double theeta;
       /// length of longest suffix
@@ -73,8 +108,8 @@ class probabilities {
 
       /// Smooth probabilities for the analysis of given word
       void smoothing(word &);
-      /// Compute p(tag|suffix) using recursively shorter suffixes.
-      double compute_probability(const std::string &, double, const std::string &);
+      /// Compute p(tag|suffix) for all unknown word tags using recursively shorter suffixes.
+      void compute_probabilities(const std::string &, std::vector<double> &) const;
       /// Guess possible tags, keeping some mass for previously assigned tags    
       double guesser(word &, double);
 
@@ -30,6 +30,8 @@
 #define _SIMILARITY
 
 #include <string>
+#include <vector>
+#include <set>
 
 using namespace std;
 
@@ -42,9 +44,14 @@ using namespace std;
 class similarity {
 
    private:
-	
-	/// Calculate the distance between two words
-	int ComputeDistance(string, string);	
+	/// Pattern bit masks (Peq), 256 entries per 64-char block of the pattern
+	std::vector<unsigned long long> peq;
+	/// Vertical delta vectors of each block
+	std::vector<unsigned long long> vp, vn;
+
+	/// Calculate the distance between two words, giving up as soon as
+	/// it is known to exceed maxdist (a negative value means no bound)
+	int ComputeDistance(const string &, const string &, int maxdist=-1);
 
    public:
       /// Constructor 
@@ -53,8 +60,22 @@ class similarity {
       ~similarity();
 
 	/// Returns the similarity between two words
-	float getSimilarity(string,string);
+	float getSimilarity(const string &, const string &);
+	/// Returns the similarity between two words if it is above minsim,
+	/// or some value not above minsim otherwise
+	float getSimilarity(const string &, const string &, float);
+	/// Returns the edit distance between two words if it is not above 
+	/// maxdist (if given), or some value above maxdist otherwise
+	int getDistance(const string &, const string &, int maxdist=-1);
+
+	/// Adds to the set all strings obtained deleting up to k chars
+	/// of the word (including the word itself)
+	static void getDeletions(const string &, int, set<string> &);
 
+	/// Key of the empty deletion in deletion indices
+	static const string EMPTY_DELETION;
+	/// Key holding the number of deletions used to build an index
+	static const string DELETION_DEPTH;
 
 };
 
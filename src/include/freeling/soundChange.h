@@ -32,6 +32,7 @@
 #include <string>
 #include <map>
 #include <vector>
+#include "regexp-pcre++.h"
 
 
 ////////////////////////////////////////////////////////////////
@@ -46,6 +47,17 @@ class ph_rule {
    std::string to;
    /// in which context
    std::string env;
+
+   /// whether the rule changes a category (char by char) or a sound
+   bool category;
+   /// for category rules, chars to replace and their replacements
+   std::string fchars, tchars;
+   /// whether the environment is a real condition (i.e. not just "_")
+   bool conditional;
+   /// environment condition, compiled when the rule is loaded
+   mutable RegEx cond;
+
+   ph_rule() : cond("") {}
 };
 
 
@@ -63,7 +75,7 @@ class soundChange {
    /// find in a text a string and replace it with another string under certain conditions
    std::string apply_rule(const std::string &, const ph_rule&) const;
    /// check that the conditions for the sound change are true
-   bool check_cond(const std::string &, const std::string &, int, const std::string &) const;
+   bool check_cond(const std::string &, const ph_rule &, int, int &) const;
 
  public:
    /// Constructor with vars and rules
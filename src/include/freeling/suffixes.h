@@ -32,6 +32,7 @@
 #include <string>
 #include <set>
 #include <map>
+#include <vector>
 
 #include "fries/language.h"
 #include "freeling/sufrule.h"
@@ -54,22 +55,31 @@ class affixes {
       /// Language-specific accent handler
       accents accen;
 
-      /// all suffixation/prefixation rules
-      std::multimap<std::string,sufrule> affix[2];
-      /// suffixation/prefixation rules applied unconditionally
-      std::multimap<std::string,sufrule> affix_always[2];
+      /// all suffixation/prefixation rules, in file order
+      std::vector<sufrule> rules[2];
 
-      /// index of existing suffix/prefixs lengths.
-      std::set<unsigned int> ExistingLength[2];
-      /// Length of longest suffix/prefix.
-      unsigned int Longest[2];
+      /// node of an affix trie: children by character, and rules
+      /// (positions in rules vector) for the affix ending at the node.
+      class trie_node {
+        public:
+          std::map<char,int> next;
+          std::vector<int> all, always;
+      };
+      /// affix tries. Suffixes are stored reversed, so both tries
+      /// are walked from the corresponding end of the word.
+      std::vector<trie_node> trie[2];
+
+      /// follow given char from a trie node, -1 if there is no such child
+      int trie_child(int, int, char) const;
+      /// find trie nodes for affixes of the word having rules (all or only "always")
+      void find_affixes(int, bool, const std::string &, std::vector<std::pair<unsigned int,int> > &) const;
 
       /// find all applicable affix rules for a word
-      void look_for_affixes_in_list (int, std::multimap<std::string,sufrule> &, word &, dictionary &) const;
+      void look_for_affixes_in_list (int, bool, word &, dictionary &);
       /// find all applicable prefix+sufix rules combination for a word
-      void look_for_combined_affixes(std::multimap<std::string,sufrule> &, std::multimap<std::string,sufrule> &, word &, dictionary &) const;
+      void look_for_combined_affixes(bool, word &, dictionary &);
       /// generate roots according to rules.
-      std::set<std::string> GenerateRoots(int, const sufrule &, const std::string &) const;
+      void GenerateRoots(int, const sufrule &, const std::string &, std::set<std::string> &) const;
       /// find roots in dictionary and apply matching rules
       void SearchRootsList(std::set<std::string> &, const std::string &, sufrule &, word &, dictionary &) const;
       /// actually apply a affix rule
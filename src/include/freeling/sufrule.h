@@ -31,6 +31,7 @@
 #ifndef _SUFFRULE
 #define _SUFFRULE
 
+#include <vector>
 #include "regexp-pcre++.h"
 
 
@@ -42,13 +43,15 @@
 class sufrule {
   public:
   std::string term,output,retok,lema;
+    /// terminations/beginnings in term, split at load ("*" stored as empty string)
+    std::vector<std::string> terms;
     RegEx cond;
     int acc,enc,always,nomore;
 
     sufrule() : cond("") {}
     sufrule(const std::string & c) : cond(c) {}
     sufrule(const sufrule & s) : cond(s.cond) {
-      term=s.term; output=s.output; retok=s.retok;
+      term=s.term; terms=s.terms; output=s.output; retok=s.retok;
       acc=s.acc; enc=s.enc; nomore=s.nomore;
       lema=s.lema; always=s.always;
     }
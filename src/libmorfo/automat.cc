@@ -26,7 +26,10 @@
 //
 ////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+
 #include "freeling/automat.h"
+#include "fries/util.h"
 #include "freeling/traces.h"
 
 using namespace std;
@@ -40,7 +43,94 @@ using namespace std;
 /// from child constructors.
 ///////////////////////////////////////////////////////////////
 
-automat::automat() {};
+automat::automat() : nstates(0), ntokens(0) {};
+
+
+///////////////////////////////////////////////////////////////
+/// Compile the automaton description given by the child class
+/// (trans and Final) into a dense table with one row per state
+/// and one column per token code, sized to the codes actually used.
+/// Transitions not given go to stopState.
+///////////////////////////////////////////////////////////////
+
+void automat::compile() {
+  map<int,map<int,int> >::const_iterator s;
+  map<int,int>::const_iterator t;
+  set<int>::const_iterator f;
+
+  // find out how many states and tokens are used
+  nstates = max(initialState,stopState)+1;
+  ntokens = 1;
+  for (s=trans.begin(); s!=trans.end(); s++) {
+    nstates = max(nstates,s->first+1);
+    for (t=s->second.begin(); t!=s->second.end(); t++) {
+      nstates = max(nstates,t->second+1);
+      ntokens = max(ntokens,t->first+1);
+    }
+  }
+  for (f=Final.begin(); f!=Final.end(); f++) 
+    nstates = max(nstates,(*f)+1);
+
+  // fill the table
+  table.assign(nstates*ntokens,stopState);
+  for (s=trans.begin(); s!=trans.end(); s++) 
+    for (t=s->second.begin(); t!=s->second.end(); t++) 
+      table[s->first*ntokens+t->first] = t->second;
+
+  final_states.assign(nstates,false);
+  for (f=Final.begin(); f!=Final.end(); f++) 
+    final_states[*f]=true;
+
+  // description no longer needed
+  trans.clear();
+  Final.clear();
+
+  TRACE(3,"Automaton compiled: "+util::int2string(nstates)+" states, "+util::int2string(ntokens)+" tokens");
+}
+
+
+///////////////////////////////////////////////////////////////
+/// Get the classification of given word, computing it the first
+/// time the word is seen in current sentence.
+///////////////////////////////////////////////////////////////
+
+automat::token_class & automat::classify(sentence::const_iterator j) {
+
+  map<const word*,token_class>::iterator c=classes.find(&(*j));
+  if (c!=classes.end()) return c->second;
+
+  token_class tc;
+  string form=j->get_form();
+  tc.lcform=util::lowercase(form);
+  tc.digit=false; 
+  tc.roman=!form.empty();
+  for (string::const_iterator k=form.begin(); k!=form.end(); k++) {
+    if (*k>='0' && *k<='9') tc.digit=true;
+    if (string("IVXLCDM").find(*k)==string::npos) tc.roman=false;
+  }
+  tc.checked=0; tc.matched=0;
+
+  return classes.insert(make_pair(&(*j),tc)).first->second;
+}
+
+
+///////////////////////////////////////////////////////////////
+/// Check whether the form of the word matches given regex.
+/// The result is stored in the word classification with the 
+/// given bit, so each regex is run at most once per word.
+/// If group>0, the submatch with that number must be non-empty.
+///////////////////////////////////////////////////////////////
+
+bool automat::check_regex(sentence::const_iterator j, unsigned int bit, RegEx &re, bool lc, int group) {
+
+  token_class &tc=classify(j);
+  if (not (tc.checked & bit)) {
+    tc.checked |= bit;
+    if (re.Search(lc ? tc.lcform : j->get_form()) && (group==0 || re.Match(group)!=""))
+      tc.matched |= bit;
+  }
+  return ((tc.matched & bit)!=0);
+}
 
 
 ///////////////////////////////////////////////////////////////
@@ -57,6 +147,8 @@ void automat::annotate(sentence &se)
   int newstate, state, token, fstate;
    
   fstate=0;
+  if (table.empty()) compile();
+  classes.clear();
 
   // check whether there is a match starting at each position i
   for (i=se.begin(); i!=se.end(); i++) {
@@ -71,7 +163,7 @@ void automat::annotate(sentence &se)
       // code for current word in current state
       token = ComputeToken(state,j,se);
       // do the transition to new state
-      newstate = trans[state][token];
+      newstate = next_state(state,token);
       // let the child class perform any actions 
       // for the new state (e.g. computing date value...)
       StateActions(state, newstate, token, j);
@@ -79,7 +171,7 @@ void automat::annotate(sentence &se)
       state = newstate;
       // if the state codes a valid match, remember it
       //  as the longest match found so long.
-      if (Final.find(state)!=Final.end()) {
+      if (final_states[state]) {
         eMatch=j;
 	fstate=state;
 	TRACE(3,"New candidate found");
@@ -92,9 +184,12 @@ void automat::annotate(sentence &se)
       TRACE(3,"Match found");
       bool found;
       i=BuildMultiword(se,sMatch,eMatch,fstate,found);
+      // words changed, classification is no longer valid
+      if (found) classes.clear();
       TRACE_SENTENCE(3,se);
     }
   }
+  classes.clear();
 
   // Printing partial module results
   TRACE_SENTENCE(1,se);
@@ -113,6 +208,8 @@ bool automat::annotate(sentence &se, sentence::iterator &i)
   bool found=false;
  
     // reset automaton
+  if (table.empty()) compile();
+  classes.clear();
   state=initialState;
   fstate=0;
   ResetActions();
@@ -123,7 +220,7 @@ bool automat::annotate(sentence &se, sentence::iterator &i)
     // code for current word in current state
     token = ComputeToken(state,j,se);
     // do the transition to new state
-    newstate = trans[state][token];
+    newstate = next_state(state,token);
     // let the child class perform any actions 
     // for the new state (e.g. computing date value...)
     StateActions(state, newstate, token, j);
@@ -131,7 +228,7 @@ bool automat::annotate(sentence &se, sentence::iterator &i)
     state = newstate;
     // if the state codes a valid match, remember it
     //  as the longest match found so long.
-    if (Final.find(state)!=Final.end()) {
+    if (final_states[state]) {
       eMatch=j;
       fstate=state;
       TRACE(3,"New candidate found");
@@ -145,6 +242,7 @@ bool automat::annotate(sentence &se, sentence::iterator &i)
     i=BuildMultiword(se,sMatch,eMatch,fstate,found);
     TRACE_SENTENCE(3,se);
   }
+  classes.clear();
 
   return(found);
 }
@@ -164,39 +262,53 @@ bool automat::ValidMultiWord(const word & w) {
 
 
 ///////////////////////////////////////////////////////////////
-///  Arrange the sentence grouping all words from start to end
-///  in a multiword.
+///  Move the words from start to end (both included) out of the 
+///  sentence into the given list, without copying them, and build
+///  the multiword form. Return the position following the words.
 ///////////////////////////////////////////////////////////////
 
-sentence::iterator automat::BuildMultiword(sentence &se, sentence::iterator start, sentence::iterator end, int fs, bool &built)
+sentence::iterator automat::SpliceMultiword(sentence &se, sentence::iterator start, sentence::iterator end, list<word> &mw, string &form) const
 {
   sentence::iterator i;
-  list<word> mw;
-  string form;
-
-  TRACE(3,"Building multiword");
 
+  form.clear();
   for (i=start; i!=end; i++){
-    mw.push_back(*i);           
     form += i->get_form()+"_";
     TRACE(3,"added next ["+form+"]");
   } 
   // don't forget last word
-  mw.push_back(*i);           
-  form += i->get_form();
+  form += end->get_form();
   TRACE(3,"added last ["+form+"]");
 
+  end++;
+  mw.splice(mw.end(), se, start, end);
+  return(end);
+}
+
+
+///////////////////////////////////////////////////////////////
+///  Arrange the sentence grouping all words from start to end
+///  in a multiword.
+///////////////////////////////////////////////////////////////
+
+sentence::iterator automat::BuildMultiword(sentence &se, sentence::iterator start, sentence::iterator end, int fs, bool &built)
+{
+  sentence::iterator i,next;
+  list<word> mw;
+  string form;
+
+  TRACE(3,"Building multiword");
+
+  // move the words out of the sentence
+  next=SpliceMultiword(se,start,end,mw,form);
+
   // build new word with the mw list, and check whether it is acceptable
   word w(form,mw);
 
   if (ValidMultiWord(w)) {  
     TRACE(3,"Valid Multiword. Modifying the sentence");
-
-    // erasing from the sentence the words that composed the multiword
-    end++;
-    i=se.erase(start, end);
-    // insert new multiword it into the sentence
-    i=se.insert(i,w); 
+    // insert new multiword into the sentence, where the words were
+    i=se.insert(next,w); 
 
     TRACE(3,"New word inserted");
     // Set morphological info for new MW
@@ -205,6 +317,8 @@ sentence::iterator automat::BuildMultiword(sentence &se, sentence::iterator star
   }
   else {
     TRACE(3,"Multiword found, but rejected. Sentence untouched");
+    // put the words back in place
+    se.splice(next,mw);
     ResetActions();
     i=start;
     built=false;
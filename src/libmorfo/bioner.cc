@@ -136,7 +136,7 @@ bioner::bioner(const std::string &conf_file) : ner(), vit(conf_file) {
 
   // create AdaBoost classifier
   TRACE(3," Loading adaboost model "+abm_file);
-  classifier = new adaboost(abm_file);
+  classifier = new compiled_adaboost(abm_file);
 
   TRACE(3,"analyzer succesfully created");
 }
@@ -155,7 +155,6 @@ bioner::~bioner(){
 void bioner::annotate(sentence &se) {
   sentence::iterator w;
   word::iterator a;
-  set<int>::iterator f;
   vector<set<int> > features;
   map<string,int>::const_iterator p;  
   int i;
@@ -163,39 +162,37 @@ void bioner::annotate(sentence &se) {
 
   // remember sentence size, we'll need it a lot of times
   int nw=se.size();
+  if (nw==0) return;
+  int nl=classifier->get_nlabels();
   
-  // Whole sentence prediction array
-  double *all_pred[nw]; 
-
-  // initialize matrix 
-  // All predictions of the sentence will be stored in an array of arrays.
-  // there are the weights for each class and each word. First index is the word, second the class
-  for (i = 0; i < nw; ++i)
-    all_pred[i] = new double[classifier->get_nlabels()];
+  // Whole sentence prediction matrix.
+  // there are the weights for each class and each word, one row per word.
+  // The buffer is kept between sentences, and only grows if needed.
+  if (all_pred.size() < size_t(nw*nl)) all_pred.resize(nw*nl);
       
   // extract sentence features
   features.clear();
   extractor->encode_int(se,features);
   TRACE(2,"Sentence encoded.");
   
-  // process each word
-  for (w=se.begin(),i=0; w!=se.end(); w++,i++) {
-    example exmp(classifier->get_nlabels());
-    
-    // add all extracted features to example
-    for (f=features[i].begin(); f!=features[i].end(); f++) exmp.add_feature(*f);
-    TRACE(4,"   example build, with "+util::int2string(exmp.size())+" features");
-    
-    // classify example
-    classifier->classify(exmp,all_pred[i]);
-
-    TRACE(3,"Example classified");
+  // collect features of all words in a single batch
+  feat_offs.clear();
+  feat_ids.clear();
+  for (i=0; i<nw; i++) {
+    feat_offs.push_back(feat_ids.size());
+    feat_ids.insert(feat_ids.end(), features[i].begin(), features[i].end());
   }
+  feat_offs.push_back(feat_ids.size());
+  TRACE(4,"   batch built, with "+util::int2string(feat_ids.size())+" features");
+
+  // classify all words at once
+  classifier->classify(nw, &feat_offs[0], feat_ids.empty() ? NULL : &feat_ids[0], &all_pred[0], ws);
+  TRACE(3,"Sentence classified");
   
   // Once all sentence has been encoded, use Viterbi algorithm to 
   // determine which is the most likely class combination
   vector<int> best;
-  best = vit.find_best_path(all_pred,nw);
+  best = vit.find_best_path(&all_pred[0],nw);
   
   // process obtained best_path and join detected NEs, syncronize it with sentence
   bool inNE=false;
@@ -227,9 +224,6 @@ void bioner::annotate(sentence &se) {
   }
   
   TRACE_SENTENCE(1,se);
-  
-  // free memory 
-  for (i = 0; i < nw; ++i) delete(all_pred[i]);
 }
 
 ///////////////////////////////////////////////////////////////
@@ -404,19 +398,15 @@ vis_viterbi::vis_viterbi(const string &P_file) {
       //  (one transition per line: "B I prob(B->I)")
       if (N==0) // we have not seen reading==1
 	ERROR_CRASH("File "+P_file+" need to have classes name/numbers before probability values");
-      if (p_trans.size()==0) { // first line, initialize vector
-	vector <double> aux;
-	for (int i=0; i<N; i++)
-	  aux.push_back(-1.0); // default value, must be changed
-	for (int i=0; i<N; i++)
-	  p_trans.push_back(aux);
+      if (p_trans.size()==0) { // first line, initialize matrix
+	p_trans.assign(N*N, -1.0); // default value, must be changed
       }
       
       sin>>name>>name1>>prob;
       map<string, int>:: iterator it_class=class_num.find(name);
       map<string, int>:: iterator it_class1=class_num.find(name1);
       if (it_class!=class_num.end() && it_class1!=class_num.end())
-	p_trans[it_class->second][it_class1->second]=atof(prob.c_str());
+	p_trans[it_class->second*N+it_class1->second]=atof(prob.c_str());
       else
 	ERROR_CRASH("Class name for NER \""+name+"\" or \""+name1+"\", not found in class/int key");
     }
@@ -428,7 +418,7 @@ vis_viterbi::vis_viterbi(const string &P_file) {
     if(p_ini[i]<0 || p_ini[i]>1)
       ERROR_CRASH("Invalid probability value for some initial probability");
     for (int j=0; j<N; j++) {
-      if(p_trans[i][j]<0 || p_trans[i][j]>1)
+      if(p_trans[i*N+j]<0 || p_trans[i*N+j]>1)
 	ERROR_CRASH("Invalid probability value for some transition probability");
     }
   }
@@ -440,24 +430,21 @@ vis_viterbi::vis_viterbi(const string &P_file) {
 /// find_best_path: perform viterbi algortihm given the weights matrix
 ////////////////////////////////////////////////////////////////
 
-vector<int> vis_viterbi::find_best_path(double** predictions, int sent_size) const {
+vector<int> vis_viterbi::find_best_path(const double* predictions, int sent_size) const {
 
-  double p, max, sum;
+  double p, max, sum, pred;
   int argmax=0;
 
   TRACE(3,"  Viterbi: processing sentence of size: "+util::int2string(sent_size));
   
-  // vector with the most likely class for each word
-  vector<int> bestp[2][N];
-  vector<int> *best_path=bestp[0];
-  vector<int> *best_path_new=bestp[1];
-  // array with the best path for reaching current word with each 
-  //  possible class
-  double paths[2][N];
-  double *p_path=paths[0];
-  double *p_path_new=paths[1];
-  // who is currently holding new path
-  int newpath=1;
+  // back[w*N+i] holds the class of word w-1 in the best path
+  // reaching word w with class i
+  vector<int> back(sent_size*N);
+  // array with the best path probability for reaching current word 
+  // with each possible class
+  vector<double> paths(2*N);
+  double *p_path=&paths[0];
+  double *p_path_new=&paths[N];
  
   // initialize this array with the weights for the first word
   //  multiplied by initial probability
@@ -465,12 +452,12 @@ vector<int> vis_viterbi::find_best_path(double** predictions, int sent_size) con
   // SoftMax function to convert weights in probabilities -- p(i)=exp(w(i))/sum(exp(w(j)))
   sum=0;
   for (int i=0; i<N; i++)
-    sum+=exp(predictions[0][i]);
+    sum+=exp(predictions[i]);
   for (int i=0; i<N; i++) {
-    p_path[i]=p_ini[i]*exp(predictions[0][i])/sum;
+    p_path[i]=p_ini[i]*exp(predictions[i])/sum;
     TRACE(4,"   initial prob for class "+util::int2string(i)+": "+util::double2string(p_path[i]));
     TRACE(4,"         p_ini["+util::int2string(i)+"]: "+util::double2string(p_ini[i]));
-    TRACE(4,"         p_pred: "+util::double2string(exp(predictions[0][i])/sum));
+    TRACE(4,"         p_pred: "+util::double2string(exp(predictions[i])/sum));
   }
 
   // predictions contains the weights for each class and each word,
@@ -478,19 +465,21 @@ vector<int> vis_viterbi::find_best_path(double** predictions, int sent_size) con
   //  most likely path.
   for (int w=1; w<sent_size; w++){ // for each word starting in the second one
     TRACE(4," studying word in position "+util::int2string(w));
+    const double *pw = predictions + w*N;
 
     // normalizing factor to convert weights in probabilities -- p(i)=exp(w(i))/sum(exp(w(j)))
     sum=0;
     for (int i=0; i<N; i++)
-      sum+=exp(predictions[w][i]);
+      sum+=exp(pw[i]);
     
     for (int i=0; i<N; i++){ // for each class, store the best probability
       TRACE(5,"   store best probability for class "+util::int2string(i));
+      pred=exp(pw[i])/sum;
       max=0; 
       for (int j=0; j<N; j++) { 
-	p=p_path[j]*(exp(predictions[w][i])/sum)*p_trans[j][i];
-	TRACE(6,"       with class "+util::int2string(j)+" p: "+util::double2string(p)+" (ptrans= "+util::double2string(p_trans[j][i])+" pred: "+util::double2string(predictions[w][i])+" normalized-pred:"+util::double2string(exp(predictions[w][i])/sum)+")");
-	if (p==0.0 && p_trans[j][i]!=0 && p_path[j]!=0) // reached null probability
+	p=p_path[j]*pred*p_trans[j*N+i];
+	TRACE(6,"       with class "+util::int2string(j)+" p: "+util::double2string(p)+" (ptrans= "+util::double2string(p_trans[j*N+i])+" pred: "+util::double2string(pw[i])+" normalized-pred:"+util::double2string(pred)+")");
+	if (p==0.0 && p_trans[j*N+i]!=0 && p_path[j]!=0) // reached null probability
 	  cerr<<" --- Null probability!! --"<<endl;
 	if(max<p) {
 	  max=p;
@@ -500,17 +489,13 @@ vector<int> vis_viterbi::find_best_path(double** predictions, int sent_size) con
 
       TRACE(5,"     best prob with class: "+util::int2string(argmax)+" p: "+util::double2string(max));
 
-      // store most likely path for this class.      
-      best_path_new[i]=best_path[argmax]; // choose as best_path for this class the path that led to best prob
-      best_path_new[i].push_back(argmax); // add current prediction
-
+      // remember which class led to best prob
+      back[w*N+i]=argmax;
       p_path_new[i]=max;
     }
     
-    // swap path new and path_new for next iteration
-    p_path = paths[newpath];      p_path_new = paths[1-newpath];
-    best_path = bestp[newpath];   best_path_new = bestp[1-newpath];
-    newpath = 1-newpath;
+    // swap path and path_new for next iteration
+    std::swap(p_path, p_path_new);
   }
   
   // once the last word is reached, choose the best path
@@ -524,11 +509,13 @@ vector<int> vis_viterbi::find_best_path(double** predictions, int sent_size) con
   
   TRACE(5,"   best path for this sentence ends with "+util::int2string(argmax)+" global p: "+util::double2string(p_path[argmax]));
 
-  // store best class for last word in best_path
-  best_path[argmax].push_back(argmax);
+  // follow back pointers from best class for last word
+  vector<int> best_path(sent_size);
+  best_path[sent_size-1]=argmax;
+  for (int w=sent_size-1; w>0; w--)
+    best_path[w-1]=back[w*N+best_path[w]];
   
   TRACE(3,"Best path found");
 
-  return (best_path[argmax]);
+  return (best_path);
 }
-
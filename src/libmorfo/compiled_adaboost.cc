@@ -0,0 +1,267 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2004   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include "freeling/compiled_adaboost.h"
+#include "freeling/traces.h"
+#include "fries/util.h"
+
+using namespace std;
+
+#define MOD_TRACENAME "ADABOOST"
+#define MOD_TRACECODE UTIL_TRACE
+
+
+///////////////////////////////////////////////////////////////
+/// Create empty workspace. Buffers are sized on first use.
+///////////////////////////////////////////////////////////////
+
+compiled_adaboost::workspace::workspace() {}
+
+
+///////////////////////////////////////////////////////////////
+/// Load AdaBoost model from given file, and build indexes.
+///////////////////////////////////////////////////////////////
+
+compiled_adaboost::compiled_adaboost(const string &fname) {
+  string line, tok, name;
+
+  ifstream fin(fname.c_str());
+  if (!fin) ERROR_CRASH("Error opening file "+fname);
+
+  // first line: label numbers and names, e.g. "0 B 1 I 2 O <others> X"
+  getline(fin,line);
+  istringstream sin(line);
+  while (sin>>tok>>name) {
+    if (tok=="<others>") others=name;
+    else {
+      size_t n=util::string2int(tok);
+      if (labels.size()<=n) labels.resize(n+1);
+      labels[n]=name;
+    }
+  }
+  nlabels=labels.size();
+  if (nlabels==0) ERROR_CRASH("No labels found in AdaBoost model "+fname);
+
+  // second line: weak rule type. Older models (e.g. as/nec/nec.abm) 
+  // do not have it, and are mlDTree with the first tree starting right away.
+  bool more = !(fin>>tok).fail();
+  if (more and tok=="mlDTree") 
+    more = !(fin>>tok).fail();
+  else if (more and tok!="---") 
+    ERROR_CRASH("Unsupported weak rule type '"+tok+"' in AdaBoost model "+fname);
+
+  // read trees, one after each "---" line, remembering which features each tree tests
+  vector<pair<int,int> > ftree;
+  while (more) {
+    if (tok!="---") ERROR_CRASH("Unexpected token '"+tok+"' in AdaBoost model "+fname);
+    vector<int> tested;
+    roots.push_back(read_tree(fin,tested,fname));
+    for (vector<int>::iterator f=tested.begin(); f!=tested.end(); f++) 
+      ftree.push_back(make_pair(*f,int(roots.size())-1));
+    more = !(fin>>tok).fail();
+  }
+
+  // sorted list of features in the model, and trees testing each of them
+  sort(ftree.begin(),ftree.end());
+  ftree.erase(unique(ftree.begin(),ftree.end()),ftree.end());
+  for (vector<pair<int,int> >::iterator p=ftree.begin(); p!=ftree.end(); p++) {
+    if (features.empty() or features.back()!=p->first) {
+      features.push_back(p->first);
+      tree_offs.push_back(tree_ids.size());
+    }
+    tree_ids.push_back(p->second);
+  }
+  tree_offs.push_back(tree_ids.size());
+
+  // nodes refer to the feature position in 'features'
+  for (size_t i=0; i<node_feat.size(); i++) 
+    if (node_feat[i]>=0) 
+      node_feat[i] = lower_bound(features.begin(),features.end(),node_feat[i]) - features.begin();
+
+  // leaf reached by each tree when no feature is active, and sum of their weights
+  base.assign(nlabels,0.0);
+  for (size_t t=0; t<roots.size(); t++) {
+    int n=roots[t];
+    while (node_feat[n]>=0) n++;
+    absent_leaf.push_back(n);
+    for (int l=0; l<nlabels; l++) base[l] += leaves[node_next[n]+l];
+  }
+
+  TRACE(3,"Loaded AdaBoost model "+fname+" with "+util::int2string(roots.size())+" rules on "+util::int2string(features.size())+" features");
+}
+
+
+///////////////////////////////////////////////////////////////
+/// Read a tree in preorder: "+ feature" is followed by the subtree 
+/// for feature absent and the subtree for feature present; 
+/// "- w1 ... wn" is a leaf with the weight of each label.
+/// Returns the position of the root node.
+///////////////////////////////////////////////////////////////
+
+int compiled_adaboost::read_tree(istream &fin, vector<int> &tested, const string &fname) {
+  string tok;
+  if (!(fin>>tok)) ERROR_CRASH("Unexpected end of AdaBoost model "+fname);
+
+  int n=node_feat.size();
+  if (tok=="+") {
+    int f;
+    fin>>f;
+    node_feat.push_back(f);
+    node_next.push_back(0);
+    tested.push_back(f);
+    // feature absent: subtree starts at n+1
+    read_tree(fin,tested,fname);
+    // feature present. Recursion may reallocate node_next, so don't 
+    // take the reference before the subtree is read.
+    int p = read_tree(fin,tested,fname);
+    node_next[n] = p;
+  }
+  else if (tok=="-") {
+    node_feat.push_back(-1);
+    node_next.push_back(leaves.size());
+    for (int l=0; l<nlabels; l++) {
+      double w;
+      fin>>w;
+      leaves.push_back(w);
+    }
+  }
+  else 
+    ERROR_CRASH("Unexpected token '"+tok+"' in AdaBoost model "+fname);
+
+  if (fin.fail()) ERROR_CRASH("Error reading AdaBoost model "+fname);
+  return n;
+}
+
+
+///////////////////////////////////////////////////////////////
+/// Leaf reached from node n with given active features
+///////////////////////////////////////////////////////////////
+
+int compiled_adaboost::tree_leaf(int n, const vector<char> &active) const {
+  while (node_feat[n]>=0) 
+    n = (active[node_feat[n]] ? node_next[n] : n+1);
+  return n;
+}
+
+
+///////////////////////////////////////////////////////////////
+/// Label information
+///////////////////////////////////////////////////////////////
+
+int compiled_adaboost::get_nlabels() const {
+  return nlabels;
+}
+
+string compiled_adaboost::get_label(int i) const {
+  return labels[i];
+}
+
+string compiled_adaboost::default_class() const {
+  return others;
+}
+
+
+///////////////////////////////////////////////////////////////
+/// Compute label weights for an example. Trees not testing any
+/// of its features contribute their precomputed 'absent' leaf.
+///////////////////////////////////////////////////////////////
+
+void compiled_adaboost::classify(const int *feats, int nf, double *pred, workspace &ws) const {
+
+  if (ws.active.size()<features.size()) ws.active.resize(features.size(),0);
+  if (ws.touched.size()<roots.size()) ws.touched.resize(roots.size(),0);
+  ws.trees.clear();
+
+  for (int l=0; l<nlabels; l++) pred[l]=base[l];
+
+  // mark active features known by the model, and collect trees testing them
+  for (int i=0; i<nf; i++) {
+    vector<int>::const_iterator p=lower_bound(features.begin(),features.end(),feats[i]);
+    if (p==features.end() or *p!=feats[i]) continue;
+
+    int k=p-features.begin();
+    ws.active[k]=1;
+    for (int j=tree_offs[k]; j<tree_offs[k+1]; j++) {
+      int t=tree_ids[j];
+      if (not ws.touched[t]) {
+        ws.touched[t]=1;
+        ws.trees.push_back(t);
+      }
+    }
+  }
+
+  // replace 'absent' leaf of those trees with the one actually reached
+  for (vector<int>::const_iterator t=ws.trees.begin(); t!=ws.trees.end(); t++) {
+    int n=tree_leaf(roots[*t],ws.active);
+    if (n!=absent_leaf[*t]) {
+      const double *w=&leaves[node_next[n]];
+      const double *w0=&leaves[node_next[absent_leaf[*t]]];
+      for (int l=0; l<nlabels; l++) pred[l] += w[l]-w0[l];
+    }
+    ws.touched[*t]=0;
+  }
+
+  // leave workspace clean for next example
+  for (int i=0; i<nf; i++) {
+    vector<int>::const_iterator p=lower_bound(features.begin(),features.end(),feats[i]);
+    if (p!=features.end() and *p==feats[i]) ws.active[p-features.begin()]=0;
+  }
+}
+
+void compiled_adaboost::classify(const vector<int> &feats, double *pred, workspace &ws) const {
+  classify(feats.empty() ? NULL : &feats[0], feats.size(), pred, ws);
+}
+
+void compiled_adaboost::classify(const set<int> &feats, double *pred, workspace &ws) const {
+  ws.feats.assign(feats.begin(),feats.end());
+  classify(ws.feats, pred, ws);
+}
+
+///////////////////////////////////////////////////////////////
+/// Convenience versions for a single example. They allocate a
+/// workspace at each call, so they are slower than those above.
+///////////////////////////////////////////////////////////////
+
+void compiled_adaboost::classify(const vector<int> &feats, double *pred) const {
+  workspace ws;
+  classify(feats, pred, ws);
+}
+
+void compiled_adaboost::classify(const set<int> &feats, double *pred) const {
+  workspace ws;
+  classify(feats, pred, ws);
+}
+
+void compiled_adaboost::classify(int n, const int *offs, const int *feats, double *pred, workspace &ws) const {
+  for (int i=0; i<n; i++) 
+    classify(feats+offs[i], offs[i+1]-offs[i], pred+i*nlabels, ws);
+}
@@ -63,6 +63,7 @@ void outSample(SAMPLE &sa){
 
 coref::coref() {
 	extractor = NULL;
+	Filters = 0;
 }
 
 ///////////////////////////////////////////////////////////////
@@ -74,6 +75,7 @@ coref::coref(const std::string &filename, const int vectors) {
   int lnum=0;
   string path=filename.substr(0,filename.find_last_of("/\\")+1);
   string line,sf,wf;
+  Filters = 0;
 
   ifstream fin;
   fin.open(filename.c_str());
@@ -94,6 +96,9 @@ coref::coref(const std::string &filename, const int vectors) {
     else if (line == "<SEMDB>") reading=3;
     else if (line == "</SEMDB>") reading=0;
 
+    else if (line == "<PairFilter>") reading=4;
+    else if (line == "</PairFilter>") reading=0;
+
     else if (reading==1) {
       ////// get .abm file absolute name
       istringstream sin;  sin.str(line);
@@ -102,7 +107,7 @@ coref::coref(const std::string &filename, const int vectors) {
       fname = util::absolute(fname,path);
       // create AdaBoost classifier
       TRACE(3," Loading adaboost model "+fname);
-      classifier = new adaboost(fname);
+      classifier = new compiled_adaboost(fname);
     }
     else if (reading==2) {
       // Read MaxDistance value
@@ -120,6 +125,16 @@ coref::coref(const std::string &filename, const int vectors) {
       else
 	WARNING("Unknown parameter "+key+" in SEMDB section of file "+filename+". SemDB not loaded");
     }
+    else if (reading==4) {
+      // Read agreement checks that discard pairs before classifying them
+      string key;
+      istringstream sin;  sin.str(line);
+      sin>>key;
+      if (key=="number") Filters |= COREFEX_FILTER_NUMBER;
+      else if (key=="gender") Filters |= COREFEX_FILTER_GENDER;
+      else
+	WARNING("Unknown filter "+key+" in PairFilter section of file "+filename+". Ignored");
+    }
   }
 
   // create feature extractor
@@ -171,6 +186,9 @@ void coref::add_candidates(int sent, int & word, parse_tree::iterator pt, list<S
       set_sample(pt, candidate);
       word = candidate.posend;
       candidate.node1 = &(pt->info);
+      candidate.node_id = pt->info.get_node_id();
+      // features of the mention alone are computed once, not for each pair
+      extractor->set_mention_features(candidate);
       candidates.push_back(candidate);
     }
     else {
@@ -184,28 +202,27 @@ void coref::add_candidates(int sent, int & word, parse_tree::iterator pt, list<S
 /// Check if the two samples are coreferents. Uses the classifier.
 ///////////////////////////////////////////////////////////////
 
-bool coref::check_coref(const SAMPLE & sa1, const SAMPLE & sa2) const{
+bool coref::check_coref(const SAMPLE & sa1, const SAMPLE & sa2, std::vector<int> & encoded, compiled_adaboost::workspace & ws) const{
   double pred[classifier->get_nlabels()];
-  std::vector<int> encoded;
-  EXAMPLE ex;
+
+  // discard pairs which do not agree, without calling the classifier
+  if (not extractor->compatible(sa1, sa2, Filters)) {
+    TRACE(5,"    -Discarded by agreement filter");
+    return false;
+  }
 
   TRACE(5,"    -Encoding example");
-  ex.sample1 = sa1;
-  ex.sample2 = sa2;
-  ex.sent = ex.sample2.sent - ex.sample1.sent;
-  //outSample(ex.sample1);
-  //outSample(ex.sample2);
-  extractor->extract(ex, encoded);
-  example exampl(classifier->get_nlabels());
+  //outSample(sa1);
+  //outSample(sa2);
+  extractor->extract(sa1, sa2, encoded);
   TRACE(5,"   Encoded example:");
   for(std::vector<int>::iterator it = encoded.begin(); it!= encoded.end(); ++it) {
-    exampl.add_feature((*it));
     TRACE(5,"          "+util::int2string(*it));
   }
 
   TRACE(5,"    -Classifying");
   // classify current example
-  classifier->classify(exampl,pred);
+  classifier->classify(encoded,pred,ws);
 
   TRACE(4,"    -Prediction for "+classifier->get_label(0)+" = "+util::double2string(pred[0]));
   TRACE(4,"    -Prediction for "+classifier->get_label(1)+" = "+util::double2string(pred[1]));
@@ -220,40 +237,58 @@ bool coref::check_coref(const SAMPLE & sa1, const SAMPLE & sa2) const{
 /////////////////////////////////////////////////////////////////////////////
 
 void coref::analyze(document & doc) const {
+  state st;
+  for (document::iterator par = doc.begin(); par != doc.end(); ++par)
+    analyze(*par, doc, st);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Classify the SN in next paragraph, comparing each of them with up to
+/// MaxDistance previous ones, which may be in previous paragraphs.
+/////////////////////////////////////////////////////////////////////////////
+
+void coref::analyze(paragraph & par, document & doc, state & st) const {
 
   list<SAMPLE> candidates;
 
   TRACE(3,"Searching for candidate noun phrases");
-  int sent1 = 0;
-  int word1 = 0;
-  for (document::iterator par = doc.begin(); par != doc.end(); ++par) {
-    for (paragraph::iterator se = par->begin(); se != par->end(); ++se) {
-      add_candidates(sent1, word1, se->get_parse_tree().begin(), candidates);
-      sent1++;
-    }
+  for (paragraph::iterator se = par.begin(); se != par.end(); ++se) {
+    add_candidates(st.sent, st.word, se->get_parse_tree().begin(), candidates);
+    st.sent++;
   }
 
   TRACE(3,"Pairing candidates ("+util::int2string(candidates.size())+")");
-  list<SAMPLE>::const_iterator i = candidates.begin();
-  ++i;
-  while (i != candidates.end()) {
+  std::vector<int> encoded;
+  compiled_adaboost::workspace ws;
+  while (not candidates.empty()) {
+    list<SAMPLE>::const_iterator i = candidates.begin();
 
     TRACE(4,"   pairing "+i->text+" with all previous");
     bool found = false;
-    bool end = false;
     int count = MaxDistance;
-    list<SAMPLE>::const_iterator j = i;
-    --j;
-    while (!end && !found && count > 0) {
-      TRACE(4,"   checking pair ("+j->text+"<"+j->node1->get_node_id()+">,"+i->text+"<"+i->node1->get_node_id()+">)");
-      found = check_coref(*j, *i);
-      if (found) doc.add_positive(j->node1->get_node_id(), i->node1->get_node_id());
-
-      if (j==candidates.begin()) end=true;
-      else --j;
+    list<SAMPLE>::const_reverse_iterator j = st.window.rbegin();
+    while (j != st.window.rend() && !found && count > 0) {
+      TRACE(4,"   checking pair ("+j->text+"<"+j->node_id+">,"+i->text+"<"+i->node_id+">)");
+      found = check_coref(*j, *i, encoded, ws);
+      if (found) doc.add_positive(j->node_id, i->node_id);
 
+      ++j;
       count--;
     }
-    ++i;
+
+    // move candidate to the window, forgetting those too far to be compared
+    st.window.splice(st.window.end(), candidates, candidates.begin());
+    if ((int)st.window.size() > MaxDistance) st.window.pop_front();
+    st.ncand++;
   }
 }
+
+int coref::get_max_distance() const {
+  return MaxDistance;
+}
+
+coref::state::state() : sent(0), word(0), ncand(0) {}
+
+int coref::state::candidates() const {
+  return ncand;
+}
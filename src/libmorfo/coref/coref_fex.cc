@@ -120,6 +120,10 @@ coref_fex::coref_fex(const int t, const int v, const string &sf, const string &w
 coref_fex::~coref_fex(){
 }
 
+
+SAMPLE::SAMPLE() : sent(0), numde(0), posbegin(0), posend(0), node1(NULL),
+                   first(0), number('0'), gender('0'), pp2(false) {}
+
 //////////////////////////////////////////////////////////////////
 ///    Function that jumps in the list of tags the tags that aren't relevant.
 //////////////////////////////////////////////////////////////////
@@ -139,8 +143,8 @@ int coref_fex::jump(const vector<string> &list){
 ///    Returns the distance in sentences of the example.
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_dist(const EXAMPLE &ex){
-	switch(ex.sent){
+int coref_fex::get_dist(int sent){
+	switch(sent){
 		case 0:
 			return COREFEX_FEATURE_SENT_SAME;
 			break;
@@ -166,8 +170,8 @@ int coref_fex::get_dist(const EXAMPLE &ex){
 ///    Returns the distance in DE's of the example.
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_numdedist(const EXAMPLE &ex){
-	int res = ex.sample2.numde - ex.sample1.numde;
+int coref_fex::get_numdedist(const SAMPLE &s1, const SAMPLE &s2){
+	int res = s2.numde - s1.numde;
 
 	switch(res){
 		case 0:
@@ -198,8 +202,8 @@ int coref_fex::get_numdedist(const EXAMPLE &ex){
 ///    Returns the distance in words of the example.
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_dedist(const EXAMPLE &ex){
-	int res = ex.sample2.posbegin - ex.sample1.posend;
+int coref_fex::get_dedist(const SAMPLE &s1, const SAMPLE &s2){
+	int res = s2.posbegin - s1.posend;
 
 	switch(res){
 		case 0:
@@ -230,11 +234,11 @@ int coref_fex::get_dedist(const EXAMPLE &ex){
 ///    Returns if 'i' are a pronoun
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_i_pronoum(const EXAMPLE &ex){
+int coref_fex::get_i_pronoum(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample1.tags);
-	if(ex.sample1.tags[pos].compare(0, 1, "p") == 0)
+	pos = jump(s.tags);
+	if(s.tags[pos].compare(0, 1, "p") == 0)
 		return COREFEX_FEATURE_IPRON;
 	else
 		return 0;
@@ -244,11 +248,11 @@ int coref_fex::get_i_pronoum(const EXAMPLE &ex){
 ///    Returns if 'j' are a pronoun
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_j_pronoum(const EXAMPLE &ex){
+int coref_fex::get_j_pronoum(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample2.tags);
-	if(ex.sample2.tags[0].compare(0, 1, "p") == 0)
+	pos = jump(s.tags);
+	if(s.tags[0].compare(0, 1, "p") == 0)
 		return COREFEX_FEATURE_JPRON;
 	else
 		return 0;
@@ -258,11 +262,11 @@ int coref_fex::get_j_pronoum(const EXAMPLE &ex){
 ///    Returns if 'i' are a pronoun of type 'personal'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_i_pronoum_p(const EXAMPLE &ex){
+int coref_fex::get_i_pronoum_p(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample1.tags);
-	if(ex.sample1.tags[pos].compare(0, 2, "pp") == 0)
+	pos = jump(s.tags);
+	if(s.tags[pos].compare(0, 2, "pp") == 0)
 		return COREFEX_FEATURE_IPRONP;
 	else
 		return 0;
@@ -272,11 +276,11 @@ int coref_fex::get_i_pronoum_p(const EXAMPLE &ex){
 ///    Returns if 'j' are a pronoun of type 'personal'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_j_pronoum_p(const EXAMPLE &ex){
+int coref_fex::get_j_pronoum_p(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample2.tags);
-	if(ex.sample2.tags[0].compare(0, 2, "pp") == 0)
+	pos = jump(s.tags);
+	if(s.tags[0].compare(0, 2, "pp") == 0)
 		return COREFEX_FEATURE_JPRONP;
 	else
 		return 0;
@@ -286,11 +290,11 @@ int coref_fex::get_j_pronoum_p(const EXAMPLE &ex){
 ///    Returns if 'i' are a pronoun of type 'demostrativo'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_i_pronoum_d(const EXAMPLE &ex){
+int coref_fex::get_i_pronoum_d(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample1.tags);
-	if(ex.sample1.tags[pos].compare(0, 2, "pd") == 0)
+	pos = jump(s.tags);
+	if(s.tags[pos].compare(0, 2, "pd") == 0)
 		return COREFEX_FEATURE_IPROND;
 	else
 		return 0;
@@ -300,11 +304,11 @@ int coref_fex::get_i_pronoum_d(const EXAMPLE &ex){
 ///    Returns if 'j' are a pronoun of type 'demostrativo'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_j_pronoum_d(const EXAMPLE &ex){
+int coref_fex::get_j_pronoum_d(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample2.tags);
-	if(ex.sample2.tags[0].compare(0, 2, "pd") == 0)
+	pos = jump(s.tags);
+	if(s.tags[0].compare(0, 2, "pd") == 0)
 		return COREFEX_FEATURE_JPROND;
 	else
 		return 0;
@@ -314,11 +318,11 @@ int coref_fex::get_j_pronoum_d(const EXAMPLE &ex){
 ///    Returns if 'i' are a pronoun of type 'posesivo'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_i_pronoum_x(const EXAMPLE &ex){
+int coref_fex::get_i_pronoum_x(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample1.tags);
-	if(ex.sample1.tags[pos].compare(0, 2, "px") == 0)
+	pos = jump(s.tags);
+	if(s.tags[pos].compare(0, 2, "px") == 0)
 		return COREFEX_FEATURE_IPRONX;
 	else
 		return 0;
@@ -328,11 +332,11 @@ int coref_fex::get_i_pronoum_x(const EXAMPLE &ex){
 ///    Returns if 'j' are a pronoun of type 'posesivo'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_j_pronoum_x(const EXAMPLE &ex){
+int coref_fex::get_j_pronoum_x(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample2.tags);
-	if(ex.sample2.tags[0].compare(0, 2, "px") == 0)
+	pos = jump(s.tags);
+	if(s.tags[0].compare(0, 2, "px") == 0)
 		return COREFEX_FEATURE_JPRONX;
 	else
 		return 0;
@@ -342,11 +346,11 @@ int coref_fex::get_j_pronoum_x(const EXAMPLE &ex){
 ///    Returns if 'i' are a pronoun of type 'indefinido'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_i_pronoum_i(const EXAMPLE &ex){
+int coref_fex::get_i_pronoum_i(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample1.tags);
-	if(ex.sample1.tags[pos].compare(0, 2, "pi") == 0)
+	pos = jump(s.tags);
+	if(s.tags[pos].compare(0, 2, "pi") == 0)
 		return COREFEX_FEATURE_IPRONI;
 	else
 		return 0;
@@ -356,11 +360,11 @@ int coref_fex::get_i_pronoum_i(const EXAMPLE &ex){
 ///    Returns if 'j' are a pronoun of type 'indefinido'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_j_pronoum_i(const EXAMPLE &ex){
+int coref_fex::get_j_pronoum_i(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample2.tags);
-	if(ex.sample2.tags[0].compare(0, 2, "pi") == 0)
+	pos = jump(s.tags);
+	if(s.tags[0].compare(0, 2, "pi") == 0)
 		return COREFEX_FEATURE_JPRONI;
 	else
 		return 0;
@@ -370,11 +374,11 @@ int coref_fex::get_j_pronoum_i(const EXAMPLE &ex){
 ///    Returns if 'i' are a pronoun of type 'interrogativo'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_i_pronoum_t(const EXAMPLE &ex){
+int coref_fex::get_i_pronoum_t(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample1.tags);
-	if(ex.sample1.tags[pos].compare(0, 2, "pt") == 0)
+	pos = jump(s.tags);
+	if(s.tags[pos].compare(0, 2, "pt") == 0)
 		return COREFEX_FEATURE_IPRONT;
 	else
 		return 0;
@@ -384,11 +388,11 @@ int coref_fex::get_i_pronoum_t(const EXAMPLE &ex){
 ///    Returns if 'j' are a pronoun of type 'interrogativo'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_j_pronoum_t(const EXAMPLE &ex){
+int coref_fex::get_j_pronoum_t(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample2.tags);
-	if(ex.sample2.tags[0].compare(0, 2, "pt") == 0)
+	pos = jump(s.tags);
+	if(s.tags[0].compare(0, 2, "pt") == 0)
 		return COREFEX_FEATURE_JPRONT;
 	else
 		return 0;
@@ -398,11 +402,11 @@ int coref_fex::get_j_pronoum_t(const EXAMPLE &ex){
 ///    Returns if 'i' are a pronoun of type 'relativo'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_i_pronoum_r(const EXAMPLE &ex){
+int coref_fex::get_i_pronoum_r(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample1.tags);
-	if(ex.sample1.tags[pos].compare(0, 2, "pr") == 0)
+	pos = jump(s.tags);
+	if(s.tags[pos].compare(0, 2, "pr") == 0)
 		return COREFEX_FEATURE_IPRONR;
 	else
 		return 0;
@@ -412,11 +416,11 @@ int coref_fex::get_i_pronoum_r(const EXAMPLE &ex){
 ///    Returns if 'j' are a pronoun of type 'relativo'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_j_pronoum_r(const EXAMPLE &ex){
+int coref_fex::get_j_pronoum_r(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample2.tags);
-	if(ex.sample2.tags[0].compare(0, 2, "pr") == 0)
+	pos = jump(s.tags);
+	if(s.tags[0].compare(0, 2, "pr") == 0)
 		return COREFEX_FEATURE_JPRONR;
 	else
 		return 0;
@@ -426,11 +430,11 @@ int coref_fex::get_j_pronoum_r(const EXAMPLE &ex){
 ///    Returns if 'i' are a pronoun of type 'exclamativo'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_i_pronoum_e(const EXAMPLE &ex){
+int coref_fex::get_i_pronoum_e(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample1.tags);
-	if(ex.sample1.tags[pos].compare(0, 2, "pe") == 0)
+	pos = jump(s.tags);
+	if(s.tags[pos].compare(0, 2, "pe") == 0)
 		return COREFEX_FEATURE_IPRONE;
 	else
 		return 0;
@@ -440,11 +444,11 @@ int coref_fex::get_i_pronoum_e(const EXAMPLE &ex){
 ///    Returns if 'j' are a pronoun of type 'exclamativo'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_j_pronoum_e(const EXAMPLE &ex){
+int coref_fex::get_j_pronoum_e(const SAMPLE &s){
 	int pos = 0;
 
-	pos = jump(ex.sample2.tags);
-	if(ex.sample2.tags[0].compare(0, 2, "pe") == 0)
+	pos = jump(s.tags);
+	if(s.tags[0].compare(0, 2, "pe") == 0)
 		return COREFEX_FEATURE_JPRONE;
 	else
 		return 0;
@@ -454,36 +458,28 @@ int coref_fex::get_j_pronoum_e(const EXAMPLE &ex){
 ///    Returns if 'i' matches the string of 'j'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_str_match(const EXAMPLE &ex){
-	vector<string>::const_iterator itT1, itT2, tag1, tag2;
-	string str1, str2;
+string coref_fex::get_str_key(const SAMPLE &s){
+	vector<string>::const_iterator itT, tag;
+	string str;
 
-	itT1 = ex.sample1.texttok.begin();
-	tag1 = ex.sample1.tags.begin();
-	while(itT1 != ex.sample1.texttok.end() && tag1 != ex.sample1.tags.end()){
+	itT = s.texttok.begin();
+	tag = s.tags.begin();
+	while(itT != s.texttok.end() && tag != s.tags.end()){
 		//Eliminates punctuation, articles and demonstrative pronouns.
-		if((*tag1).compare(0, 1, "f") != 0 && (*tag1).compare(0, 1, "d") != 0  && (*tag1).compare(0, 2, "pd") != 0
-		  && (*tag1).compare(0, 1, "s") != 0 && (*tag1).compare(0, 1, "i") != 0 && (*tag1).compare(0, 1, "r") != 0
-		  && (*tag1).compare(0, 1, "c") != 0){
-			str1 += (*itT1);
+		if((*tag).compare(0, 1, "f") != 0 && (*tag).compare(0, 1, "d") != 0  && (*tag).compare(0, 2, "pd") != 0
+		  && (*tag).compare(0, 1, "s") != 0 && (*tag).compare(0, 1, "i") != 0 && (*tag).compare(0, 1, "r") != 0
+		  && (*tag).compare(0, 1, "c") != 0){
+			str += (*itT);
 		}
-		++itT1;
-		++tag1;
+		++itT;
+		++tag;
 	}
+	return str;
+}
 
-	itT2 = ex.sample2.texttok.begin();
-	tag2 = ex.sample2.tags.begin();
-	while(itT2 != ex.sample2.texttok.end() && tag2 != ex.sample2.tags.end()){
-		if((*tag2).compare(0, 1, "f") != 0 && (*tag2).compare(0, 1, "d") != 0  && (*tag2).compare(0, 2, "pd") != 0
-		  && (*tag2).compare(0, 1, "s") != 0 && (*tag2).compare(0, 1, "i") != 0 && (*tag2).compare(0, 1, "r") != 0
-		  && (*tag2).compare(0, 1, "c") != 0){
-			str2 += (*itT2);
-		}
-		++itT2;
-		++tag2;
-	}
 
-	if(str1 == str2 && str1.size() > 1){
+int coref_fex::get_str_match(const SAMPLE &s1, const SAMPLE &s2){
+	if(s1.strkey == s2.strkey && s1.strkey.size() > 1){
 		return COREFEX_FEATURE_STRMATH;
 	}else
 		return 0;
@@ -493,12 +489,12 @@ int coref_fex::get_str_match(const EXAMPLE &ex){
 ///    Returns if 'j' are definite noun phrase
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_def_np(const EXAMPLE &ex){
+int coref_fex::get_def_np(const SAMPLE &s){
 	unsigned int pos = 0;
 
-	pos = jump(ex.sample2.tags);
-	if(ex.sample2.tags.size() > (pos+1)){
-		if((ex.sample2.tags[pos].compare(0, 2, "da") == 0) && ex.sample2.tags[pos+1].compare(0, 2, "nc") == 0)
+	pos = jump(s.tags);
+	if(s.tags.size() > (pos+1)){
+		if((s.tags[pos].compare(0, 2, "da") == 0) && s.tags[pos+1].compare(0, 2, "nc") == 0)
 			return COREFEX_FEATURE_DEFNP;
 		else
 			return 0;
@@ -511,12 +507,12 @@ int coref_fex::get_def_np(const EXAMPLE &ex){
 ///    Returns if 'j' are demonstrative noun phrase
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_dem_np(const EXAMPLE &ex){
+int coref_fex::get_dem_np(const SAMPLE &s){
 	unsigned int pos = 0;
 
-	pos = jump(ex.sample2.tags);
-	if(ex.sample2.tags.size() > (pos+1)){
-		if(ex.sample2.tags[pos].compare(0, 2, "dd") == 0 && ex.sample2.tags[pos+1].compare(0, 2, "nc") == 0)
+	pos = jump(s.tags);
+	if(s.tags.size() > (pos+1)){
+		if(s.tags[pos].compare(0, 2, "dd") == 0 && s.tags[pos+1].compare(0, 2, "nc") == 0)
 			return COREFEX_FEATURE_DEMNP;
 		else
 			return 0;
@@ -529,29 +525,23 @@ int coref_fex::get_dem_np(const EXAMPLE &ex){
 ///    Returns if 'i' and 'j' agree in number
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_number(const EXAMPLE &ex){
-	char num1='0', num2='0';
-	unsigned int pos = 0;
-
-	pos = jump(ex.sample1.tags);
+char coref_fex::get_number_value(const SAMPLE &s){
+	char num='0';
+	unsigned int pos = s.first;
 
 	//Articulos, adjetivos y pronombres
-	if(ex.sample1.tags[pos].compare(0, 1, "a") == 0 || ex.sample1.tags[pos].compare(0, 1, "d") == 0 || ex.sample1.tags[pos].compare(0, 1, "p") == 0){
-		num1 = ex.sample1.tags[pos][4];
+	if(s.tags[pos].compare(0, 1, "a") == 0 || s.tags[pos].compare(0, 1, "d") == 0 || s.tags[pos].compare(0, 1, "p") == 0){
+		num = s.tags[pos][4];
 	//Nombres y preposiciones
-	} else if(ex.sample1.tags[pos].compare(0, 2, "nc") == 0 || ex.sample1.tags[pos].compare(0, 3, "spc") == 0 ){
-		num1 = ex.sample1.tags[pos][3];
+	} else if(s.tags[pos].compare(0, 2, "nc") == 0 || s.tags[pos].compare(0, 3, "spc") == 0 ){
+		num = s.tags[pos][3];
 	}
+	return num;
+}
 
-	pos = jump(ex.sample2.tags);
 
-	//Articulos, adjetivos y pronombres
-	if(ex.sample2.tags[pos].compare(0, 1, "a") == 0 || ex.sample2.tags[pos].compare(0, 1, "d") == 0 || ex.sample2.tags[pos].compare(0, 1, "p") == 0){
-		num2 = ex.sample2.tags[pos][4];
-	//Nombres y preposiciones
-	} else if(ex.sample2.tags[pos].compare(0, 2, "nc") == 0 || ex.sample2.tags[pos].compare(0, 3, "spc") == 0 ){
-		num2 = ex.sample2.tags[pos][3];
-	}
+int coref_fex::get_number(const SAMPLE &s1, const SAMPLE &s2){
+	char num1=s1.number, num2=s2.number;
 
 	if(num1 == num2 && num1 != '0')
 		return COREFEX_FEATURE_NUMBER;
@@ -567,104 +557,71 @@ int coref_fex::get_number(const EXAMPLE &ex){
 ///    is a common noun
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_semclass(const EXAMPLE &ex){
-	unsigned int pos1, pos2;
-	vector<string> txt1 = tokenize(ex.sample1.text," ");
-	vector<string> txt2 = tokenize(ex.sample2.text," ");
-	string t1, t2, tag1, tag2, type1, type2;
-
-	pos1 = 0;
-	pos2 = 0;
-	tag1 = ex.sample1.tags[pos1];
-	tag2 = ex.sample2.tags[pos2];
-	t1 = txt1[pos1];
-	t2 = txt2[pos2];
-	while (tag1.compare(0, 1, "n") != 0 && txt1.size() > (pos1+1)) {
-		pos1++;
-		t1 = txt1[pos1];
-		tag1 = ex.sample1.tags[pos1];
- 	}
-	while ((tag2.compare(0, 1, "n") != 0 && tag2.compare(0, 2, "pp") != 0) && txt2.size() > (pos2+1)) {
-		pos2++;
-		t2 = txt2[pos2];
-		tag2 = ex.sample2.tags[pos2];
+string coref_fex::get_semclass_type(const SAMPLE &s, bool second, bool &pp){
+	unsigned int pos;
+	vector<string> txt = tokenize(s.text," ");
+	string t, tag, type;
+
+	pos = 0;
+	tag = s.tags[pos];
+	t = txt[pos];
+	//The second mention of a pair may also be a personal pronoun
+	while ((tag.compare(0, 1, "n") != 0 && (!second || tag.compare(0, 2, "pp") != 0)) && txt.size() > (pos+1)) {
+		pos++;
+		t = txt[pos];
+		tag = s.tags[pos];
 	}
+	pp = (tag.compare(0, 2, "pp") == 0);
+
 	//Gets the NEC if the tag are a proper noun
-	if(tag1.compare(0, 2, "np") == 0){
-		type1 = tag1[4];
-		type1 += tag1[5];
-	}
-	if(tag2.compare(0, 2, "np") == 0){
-		type2 = tag2[4];
-		type2 += tag2[5];
+	if(tag.compare(0, 2, "np") == 0){
+		type = tag[4];
+		type += tag[5];
 	}
 
 	//Gets the class from the wordnet if the tag is a common noun
-	if(tag1.compare(0, 2, "nc") == 0 || tag2.compare(0, 2, "nc") == 0 || type1 == "00" || type2 == "00"){
-		list< std::string > l1, l2;
+	if(tag.compare(0, 2, "nc") == 0 || type == "00"){
+		list< std::string > l;
 		list< std::string >::iterator it;
 
-		if(tag1.compare(0, 2, "nc") == 0 || type1 == "00"){
-			l1 = semdb->get_word_senses(t1, "N");
-			if (not l1.empty()) {
-				if (not l1.begin()->empty()) {
-					sense_info si = semdb->get_sense_info (l1.front(), "N");
-					bool check_human=false, check_group=false, check_place=false;
-					for(it = si.tonto.begin(); it != si.tonto.end() ; ++it){
-						if((*it) == "Human"){
-							check_human = true;
-						} else if((*it) == "Group"){
-							check_group = true;
-						} else if((*it) == "Place"){
-							check_place = true;
-						}
-					}
-					if(check_human && !check_group){
-						type1 = "sp";
-					} else if(check_human && check_group){
-						type1 = "o0";
-					} else if(check_place){
-						type1 = "g0";
-					} else if(type1 == "00" || type1 == ""){
-						type1 = "v0";
+		l = semdb->get_word_senses(t, "N");
+		if (not l.empty()) {
+			if (not l.begin()->empty()) {
+				sense_info si = semdb->get_sense_info (l.front(), "N");
+				bool check_human=false, check_group=false, check_place=false;
+				for(it = si.tonto.begin(); it != si.tonto.end() ; ++it){
+					if((*it) == "Human"){
+						check_human = true;
+					} else if((*it) == "Group"){
+						check_group = true;
+					} else if((*it) == "Place"){
+						check_place = true;
 					}
 				}
-			}
-		}
-
-		if(tag2.compare(0, 2, "nc") == 0 || type2 == "00"){
-			l2 = semdb->get_word_senses(t2, "N");
-			if (not l2.empty()) {
-				if (not l2.begin()->empty()) {
-					sense_info si = semdb->get_sense_info (l2.front(), "N");
-					bool check_human=false, check_group=false, check_place=false;
-					for(it = si.tonto.begin(); it != si.tonto.end() ; ++it){
-						if((*it) == "Human"){
-							check_human = true;
-						} else if((*it) == "Group"){
-							check_group = true;
-						} else if((*it) == "Place"){
-							check_place = true;
-						}
-					}
-					if(check_human && !check_group){
-						type2 = "sp";
-					} else if(check_human && check_group){
-						type2 = "o0";
-					} else if(check_place){
-						type2 = "g0";
-					} else if(type2 == "00" || type2 == ""){
-						type2 = "v0";
-					}
+				if(check_human && !check_group){
+					type = "sp";
+				} else if(check_human && check_group){
+					type = "o0";
+				} else if(check_place){
+					type = "g0";
+				} else if(type == "00" || type == ""){
+					type = "v0";
 				}
 			}
 		}
 	}
+	return type;
+}
+
+
+int coref_fex::get_semclass(const SAMPLE &s1, const SAMPLE &s2){
+	const string &type1 = s1.semclass1;
+	const string &type2 = s2.semclass2;
+
 	if(type1 == type2 && type1 != ""){
 		return COREFEX_FEATURE_SEMCLASS;
-	} else if(type1 == "sp" && tag2.compare(0, 2, "pp") == 0){
+	} else if(type1 == "sp" && s2.pp2){
 		return COREFEX_FEATURE_SEMCLASS;
-//	} else if(type1 == "" && type2 ==
 	}
 	return 0;
 }
@@ -673,30 +630,23 @@ int coref_fex::get_semclass(const EXAMPLE &ex){
 ///    Returns if 'i' and 'j' agree in gender
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_gender(const EXAMPLE &ex){
-	char gen1='0', gen2='0';
-	unsigned int pos = 0;
-
-	pos = jump(ex.sample1.tags);
+char coref_fex::get_gender_value(const SAMPLE &s){
+	char gen='0';
+	unsigned int pos = s.first;
 
 	//Articulos, adjetivos y pronombres
-	if(ex.sample1.tags[pos].compare(0, 1, "a") == 0 || ex.sample1.tags[pos].compare(0, 1, "d") == 0 || ex.sample1.tags[pos].compare(0, 1, "p") == 0){
-		gen1 = ex.sample1.tags[pos][3];
+	if(s.tags[pos].compare(0, 1, "a") == 0 || s.tags[pos].compare(0, 1, "d") == 0 || s.tags[pos].compare(0, 1, "p") == 0){
+		gen = s.tags[pos][3];
 	//Nombres y preposiciones
-	} else if(ex.sample1.tags[pos].compare(0, 1, "n") == 0 || ex.sample1.tags[pos].compare(0, 3, "spc") == 0 ){
-		gen1 = ex.sample1.tags[pos][2];
+	} else if(s.tags[pos].compare(0, 1, "n") == 0 || s.tags[pos].compare(0, 3, "spc") == 0 ){
+		gen = s.tags[pos][2];
 	}
+	return gen;
+}
 
 
-	pos = jump(ex.sample2.tags);
-
-	//Articulos, adjetivos y pronombres
-	if(ex.sample2.tags[pos].compare(0, 1, "a") == 0 || ex.sample2.tags[pos].compare(0, 1, "d") == 0 || ex.sample2.tags[pos].compare(0, 1, "p") == 0){
-		gen2 = ex.sample2.tags[pos][3];
-	//Nombres y preposiciones
-	} else if(ex.sample2.tags[pos].compare(0, 1, "n") == 0 || ex.sample2.tags[pos].compare(0, 3, "spc") == 0 ){
-		gen2 = ex.sample2.tags[pos][2];
-	}
+int coref_fex::get_gender(const SAMPLE &s1, const SAMPLE &s2){
+	char gen1=s1.gender, gen2=s2.gender;
 
 	if(gen1 == gen2 && gen1 != '0')
 		return COREFEX_FEATURE_GENDER;
@@ -710,12 +660,8 @@ int coref_fex::get_gender(const EXAMPLE &ex){
 ///    Returns if 'i' and 'j' are proper nouns
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_proper_name(const EXAMPLE &ex){
-	int pos1, pos2;
-
-	pos1 = jump(ex.sample1.tags);
-	pos2 = jump(ex.sample2.tags);
-	if(ex.sample1.tags[pos1].compare(0, 2, "np") == 0 && ex.sample2.tags[pos2].compare(0, 2, "np") == 0)
+int coref_fex::get_proper_name(const SAMPLE &s1, const SAMPLE &s2){
+	if(s1.tags[s1.first].compare(0, 2, "np") == 0 && s2.tags[s2.first].compare(0, 2, "np") == 0)
 		return COREFEX_FEATURE_PROPERNAME;
 	else
 		return 0;
@@ -725,8 +671,8 @@ int coref_fex::get_proper_name(const EXAMPLE &ex){
 ///    Returns if the two words matches
 //////////////////////////////////////////////////////////////////
 
-bool coref_fex::check_word(string w1, string w2){
-	string::iterator si, si2;
+bool coref_fex::check_word(const string &w1, const string &w2){
+	string::const_iterator si, si2;
 
 	si = w1.begin();
 	si2 = w2.begin();
@@ -746,20 +692,20 @@ bool coref_fex::check_word(string w1, string w2){
 ///    Returns if 'j' are an acronim of 'i'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::check_acronim(const EXAMPLE &ex){
+int coref_fex::check_acronim(const SAMPLE &s1, const SAMPLE &s2){
 	string::const_iterator si, si2;
 	int ret=1;
 	int cEquals, cTotal;
 
-	if(ex.sample2.tags.size() != 1 && ex.sample2.tags.size() != 3 )
+	if(s2.tags.size() != 1 && s2.tags.size() != 3 )
 		return 0;
-	if(ex.sample1.tags[0].compare(0, 2, "np") != 0)
+	if(s1.tags[0].compare(0, 2, "np") != 0)
 		return 0;
-	if(ex.sample2.tags.size() == 1){
-		if(ex.sample2.tags[0].compare(0, 2, "np") != 0)
+	if(s2.tags.size() == 1){
+		if(s2.tags[0].compare(0, 2, "np") != 0)
 			return 0;
-	} else if(ex.sample2.tags.size() == 3){
-		if(ex.sample2.tags[1].compare(0, 2, "np") != 0)
+	} else if(s2.tags.size() == 3){
+		if(s2.tags[1].compare(0, 2, "np") != 0)
 			return 0;
 	}
 
@@ -767,9 +713,9 @@ int coref_fex::check_acronim(const EXAMPLE &ex){
 		bool wbegin = true;
 
 		cEquals=0, cTotal=1;
-		si = ex.sample2.text.begin();
-		si2 = ex.sample1.text.begin();
-		while(si != ex.sample2.text.end() && si2 != ex.sample1.text.end()){
+		si = s2.text.begin();
+		si2 = s1.text.begin();
+		while(si != s2.text.end() && si2 != s1.text.end()){
 			while(*si == '(' || *si == ')' || *si == '.' || *si == '_' || *si == ' ')
 				++si;
 			if(wbegin && std::toupper(*si) == std::toupper(*si2)){
@@ -784,13 +730,13 @@ int coref_fex::check_acronim(const EXAMPLE &ex){
 			}
 			++si2;
 		}
-		while(si2 != ex.sample1.text.end()){
+		while(si2 != s1.text.end()){
 			if( *si2 == ' ' || *si2 == '_'){
 				cTotal++;
 			}
 			++si2;
 		}
-		if(si != ex.sample2.text.end()){
+		if(si != s2.text.end()){
 			ret=0;
 		} else if(cEquals <= (cTotal/2)){
 			ret=0;
@@ -803,20 +749,20 @@ int coref_fex::check_acronim(const EXAMPLE &ex){
 ///    Returns if 'j' are an prefix of 'i'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::check_fixesleft(const EXAMPLE &ex){
+int coref_fex::check_fixesleft(const SAMPLE &s1, const SAMPLE &s2){
 	vector<string>::const_iterator itT1, itT2;
 	vector<string>::const_reverse_iterator ritT1, ritT2;
-	int total1 = ex.sample1.texttok.size();
-	int total2 = ex.sample2.texttok.size();
+	int total1 = s1.texttok.size();
+	int total2 = s2.texttok.size();
 	int max = (total1 > total2) ? total1 : total2;
 	int count;
 	int ret = 0;
 
 	if(total1 >= 1 && total2 >= 1 && max > 1){
-		itT1 = ex.sample1.texttok.begin();
-		itT2 = ex.sample2.texttok.begin();
+		itT1 = s1.texttok.begin();
+		itT2 = s2.texttok.begin();
 		count = 0;
-		while(itT1 != ex.sample1.texttok.end() && itT2 != ex.sample2.texttok.end()){
+		while(itT1 != s1.texttok.end() && itT2 != s2.texttok.end()){
 			if(check_word(*itT1, *itT2)){
 				count++;
 			} else {
@@ -836,20 +782,20 @@ int coref_fex::check_fixesleft(const EXAMPLE &ex){
 ///    Returns if 'j' are an suffix of 'i'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::check_fixesright(const EXAMPLE &ex){
+int coref_fex::check_fixesright(const SAMPLE &s1, const SAMPLE &s2){
 	vector<string>::const_iterator itT1, itT2;
 	vector<string>::const_reverse_iterator ritT1, ritT2;
-	int total1 = ex.sample1.texttok.size();
-	int total2 = ex.sample2.texttok.size();
+	int total1 = s1.texttok.size();
+	int total2 = s2.texttok.size();
 	int max = (total1 > total2) ? total1 : total2;
 	int count;
 	int ret = 0;
 
 	if(total1 >= 1 && total2 >= 1 && max > 1){
-		ritT1 = ex.sample1.texttok.rbegin();
-		ritT2 = ex.sample2.texttok.rbegin();
+		ritT1 = s1.texttok.rbegin();
+		ritT2 = s2.texttok.rbegin();
 		count = 0;
-		while(ritT1 != ex.sample1.texttok.rend() && ritT2 != ex.sample2.texttok.rend()){
+		while(ritT1 != s1.texttok.rend() && ritT2 != s2.texttok.rend()){
 			if(check_word(*ritT1, *ritT2)){
 				count++;
 			} else {
@@ -869,18 +815,18 @@ int coref_fex::check_fixesright(const EXAMPLE &ex){
 ///    Returns if the words of 'j' appears in ths same order in 'i'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::check_order(const EXAMPLE &ex){
+int coref_fex::check_order(const SAMPLE &s1, const SAMPLE &s2){
 	vector<string>::const_iterator itT1, itT2;
 
-	itT1 = ex.sample1.texttok.begin();
-	itT2 = ex.sample2.texttok.begin();
-	while(itT1 != ex.sample1.texttok.end() && itT2 != ex.sample2.texttok.end()){
+	itT1 = s1.texttok.begin();
+	itT2 = s2.texttok.begin();
+	while(itT1 != s1.texttok.end() && itT2 != s2.texttok.end()){
 		if(check_word(*itT1, *itT2)){
 			++itT2;
 		}
 		++itT1;
 	}
-	if(itT2 == ex.sample2.texttok.end() && ex.sample2.texttok.size() > 1){
+	if(itT2 == s2.texttok.end() && s2.texttok.size() > 1){
 		return 1;
 	}else{
 		return 0;
@@ -891,8 +837,8 @@ int coref_fex::check_order(const EXAMPLE &ex){
 ///    Returns if 'j' are an acronim of 'i'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_alias_acro(const EXAMPLE &ex){
-	if(check_acronim(ex) != 0)
+int coref_fex::get_alias_acro(const SAMPLE &s1, const SAMPLE &s2){
+	if(check_acronim(s1, s2) != 0)
 		return COREFEX_FEATURE_ACRONIM;
 	else
 		return(0);
@@ -902,8 +848,8 @@ int coref_fex::get_alias_acro(const EXAMPLE &ex){
 ///    Returns if 'j' are an prefix of 'i'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_alias_fixleft(const EXAMPLE &ex){
-	if(check_fixesleft(ex) != 0)
+int coref_fex::get_alias_fixleft(const SAMPLE &s1, const SAMPLE &s2){
+	if(check_fixesleft(s1, s2) != 0)
 		return COREFEX_FEATURE_FIXLEFT;
 	else
 		return(0);
@@ -913,8 +859,8 @@ int coref_fex::get_alias_fixleft(const EXAMPLE &ex){
 ///    Returns if 'j' are an suffix of 'i'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_alias_fixright(const EXAMPLE &ex){
-	if(check_fixesright(ex) != 0)
+int coref_fex::get_alias_fixright(const SAMPLE &s1, const SAMPLE &s2){
+	if(check_fixesright(s1, s2) != 0)
 		return COREFEX_FEATURE_FIXRIGHT;
 	else
 		return(0);
@@ -924,8 +870,8 @@ int coref_fex::get_alias_fixright(const EXAMPLE &ex){
 ///    Returns if the words of 'j' appears in ths same order in 'i'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_alias_order(const EXAMPLE &ex){
-	if(check_order(ex) != 0)
+int coref_fex::get_alias_order(const SAMPLE &s1, const SAMPLE &s2){
+	if(check_order(s1, s2) != 0)
 		return COREFEX_FEATURE_ORDER;
 	else
 		return(0);
@@ -935,80 +881,80 @@ int coref_fex::get_alias_order(const EXAMPLE &ex){
 ///    Returns if 'j' are in apposition of 'i'
 //////////////////////////////////////////////////////////////////
 
-int coref_fex::get_appositive(const EXAMPLE &ex){
+int coref_fex::get_appositive(const SAMPLE &s1, const SAMPLE &s2){
 	int ret = 0;
 
-	if( ex.sample2.posbegin > ex.sample1.posbegin && ex.sample2.posbegin == (ex.sample1.posend+1) ) {
-//		if(ex.sample2.tags[0] == "fpa" || ex.sample2.tags[0] == "fc"){
-		if(ex.sample2.tags[0] == "fc"){
+	if( s2.posbegin > s1.posbegin && s2.posbegin == (s1.posend+1) ) {
+//		if(s2.tags[0] == "fpa" || s2.tags[0] == "fc"){
+		if(s2.tags[0] == "fc"){
 			ret = COREFEX_FEATURE_APPOS;
 		}
 	}
 	return ret;
 }
-int coref_fex::get_i_inquotes(const EXAMPLE &ex){
+int coref_fex::get_i_inquotes(const SAMPLE &s){
 	int ret = 0;
 
-	if(ex.sample1.tags.size() > 2){
-		if(ex.sample1.tags[0] == "fe" && ex.sample1.tags[ex.sample1.tags.size()-1] == "fe"){
+	if(s.tags.size() > 2){
+		if(s.tags[0] == "fe" && s.tags[s.tags.size()-1] == "fe"){
 			ret = COREFEX_FEATURE_IQUOTE;
-		}else if(ex.sample1.tags[0] == "fra" && ex.sample1.tags[ex.sample1.tags.size()-1] == "frc"){
+		}else if(s.tags[0] == "fra" && s.tags[s.tags.size()-1] == "frc"){
 			ret = COREFEX_FEATURE_IQUOTE;
 		}
 	}
 	return ret;
 }
-int coref_fex::get_j_inquotes(const EXAMPLE &ex){
+int coref_fex::get_j_inquotes(const SAMPLE &s){
 	int ret = 0;
 
-	if(ex.sample2.tags.size() > 2){
-		if(ex.sample2.tags[0] == "fe" && ex.sample2.tags[ex.sample2.tags.size()-1] == "fe"){
+	if(s.tags.size() > 2){
+		if(s.tags[0] == "fe" && s.tags[s.tags.size()-1] == "fe"){
 			ret = COREFEX_FEATURE_JQUOTE;
-		}else if(ex.sample2.tags[0] == "fra" && ex.sample2.tags[ex.sample2.tags.size()-1] == "frc"){
+		}else if(s.tags[0] == "fra" && s.tags[s.tags.size()-1] == "frc"){
 			ret = COREFEX_FEATURE_JQUOTE;
 		}
 	}
 	return ret;
 }
-int coref_fex::get_i_inparenthesis(const EXAMPLE &ex){
+int coref_fex::get_i_inparenthesis(const SAMPLE &s){
 	int ret = 0;
 
-	if(ex.sample1.tags.size() > 2){
-		if(ex.sample1.tags[0] == "fpa" && ex.sample1.tags[ex.sample1.tags.size()-1] == "fpt"){
+	if(s.tags.size() > 2){
+		if(s.tags[0] == "fpa" && s.tags[s.tags.size()-1] == "fpt"){
 			ret = COREFEX_FEATURE_IPARENTHESIS;
 		}
 	}
 	return ret;
 }
-int coref_fex::get_j_inparenthesis(const EXAMPLE &ex){
+int coref_fex::get_j_inparenthesis(const SAMPLE &s){
 	int ret = 0;
 
-	if(ex.sample2.tags.size() > 2){
-		if(ex.sample2.tags[0] == "fpa" && ex.sample2.tags[ex.sample2.tags.size()-1] == "fpt"){
+	if(s.tags.size() > 2){
+		if(s.tags[0] == "fpa" && s.tags[s.tags.size()-1] == "fpt"){
 			ret = COREFEX_FEATURE_JPARENTHESIS;
 		}
 	}
 	return ret;
 }
-int coref_fex::get_i_thirtperson(const EXAMPLE &ex){
+int coref_fex::get_i_thirtperson(const SAMPLE &s){
 	int pos = 0;
 	char p = '0';
 
-	pos = jump(ex.sample1.tags);
-	if(ex.sample1.tags[pos].compare(0, 1, "d") == 0 || ex.sample1.tags[pos].compare(0, 1, "p") == 0)
-		p = ex.sample1.tags[pos][2];
+	pos = jump(s.tags);
+	if(s.tags[pos].compare(0, 1, "d") == 0 || s.tags[pos].compare(0, 1, "p") == 0)
+		p = s.tags[pos][2];
 	if(p == '3')
 		return COREFEX_FEATURE_ITHIRT;
 	else
 		return 0;
 }
-int coref_fex::get_j_thirtperson(const EXAMPLE &ex){
+int coref_fex::get_j_thirtperson(const SAMPLE &s){
 	int pos = 0;
 	char p = '0';
 
-	pos = jump(ex.sample2.tags);
-	if(ex.sample2.tags[pos].compare(0, 1, "d") == 0 || ex.sample2.tags[pos].compare(0, 1, "p") == 0)
-		p = ex.sample2.tags[pos][2];
+	pos = jump(s.tags);
+	if(s.tags[pos].compare(0, 1, "d") == 0 || s.tags[pos].compare(0, 1, "p") == 0)
+		p = s.tags[pos][2];
 	if(p == '3')
 		return COREFEX_FEATURE_JTHIRT;
 	else
@@ -1044,73 +990,117 @@ void coref_fex::put_feature(int f, std::vector<int> &result){
 	if(f > 0)
 		result.push_back(f);
 }
-void coref_fex::extract(EXAMPLE &ex, std::vector<int> &result){
-	result.clear();
-
-	if (vectors & COREFEX_DIST){
-		result.push_back(get_dist(ex));
-		result.push_back(get_numdedist(ex));
-		result.push_back(get_dedist(ex));
+void coref_fex::set_mention_features(SAMPLE &s){
+	s.first = jump(s.tags);
+	s.number = get_number_value(s);
+	s.gender = get_gender_value(s);
+	s.strkey = get_str_key(s);
+	bool pp;
+	if (vectors & COREFEX_SEMCLASS) {
+		s.semclass1 = get_semclass_type(s, false, pp);
+		s.semclass2 = get_semclass_type(s, true, s.pp2);
 	}
 
+	// features of the mention as first element of a pair
+	vector<int> &f1 = s.feats1;
+	f1.clear();
 	if (vectors & COREFEX_IPRON)
-		put_feature(get_i_pronoum(ex), result);
-	if (vectors & COREFEX_JPRON)
-		put_feature(get_j_pronoum(ex), result);
-
+		put_feature(get_i_pronoum(s), f1);
 	if (vectors & COREFEX_IPRONM) {
-		put_feature(get_i_pronoum_p(ex), result);
-		put_feature(get_i_pronoum_d(ex), result);
-		put_feature(get_i_pronoum_x(ex), result);
-		put_feature(get_i_pronoum_i(ex), result);
-		put_feature(get_i_pronoum_t(ex), result);
-		put_feature(get_i_pronoum_r(ex), result);
-		put_feature(get_i_pronoum_e(ex), result);
+		put_feature(get_i_pronoum_p(s), f1);
+		put_feature(get_i_pronoum_d(s), f1);
+		put_feature(get_i_pronoum_x(s), f1);
+		put_feature(get_i_pronoum_i(s), f1);
+		put_feature(get_i_pronoum_t(s), f1);
+		put_feature(get_i_pronoum_r(s), f1);
+		put_feature(get_i_pronoum_e(s), f1);
 	}
+	put_feature(get_i_inquotes(s), f1);
+	put_feature(get_i_inparenthesis(s), f1);
+	put_feature(get_i_thirtperson(s), f1);
 
+	// features of the mention as second element of a pair
+	vector<int> &f2 = s.feats2;
+	f2.clear();
+	if (vectors & COREFEX_JPRON)
+		put_feature(get_j_pronoum(s), f2);
 	if (vectors & COREFEX_JPRONM) {
-		put_feature(get_j_pronoum_p(ex), result);
-		put_feature(get_j_pronoum_d(ex), result);
-		put_feature(get_j_pronoum_x(ex), result);
-		put_feature(get_j_pronoum_i(ex), result);
-		put_feature(get_j_pronoum_t(ex), result);
-		put_feature(get_j_pronoum_r(ex), result);
-		put_feature(get_j_pronoum_e(ex), result);
+		put_feature(get_j_pronoum_p(s), f2);
+		put_feature(get_j_pronoum_d(s), f2);
+		put_feature(get_j_pronoum_x(s), f2);
+		put_feature(get_j_pronoum_i(s), f2);
+		put_feature(get_j_pronoum_t(s), f2);
+		put_feature(get_j_pronoum_r(s), f2);
+		put_feature(get_j_pronoum_e(s), f2);
 	}
-
-	if (vectors & COREFEX_STRMATCH)
-		put_feature(get_str_match(ex), result);
 	if (vectors & COREFEX_DEFNP)
-		put_feature(get_def_np(ex), result);
+		put_feature(get_def_np(s), f2);
 	if (vectors & COREFEX_DEMNP)
-		put_feature(get_dem_np(ex), result);
+		put_feature(get_dem_np(s), f2);
+	put_feature(get_j_inquotes(s), f2);
+	put_feature(get_j_inparenthesis(s), f2);
+	put_feature(get_j_thirtperson(s), f2);
+}
+
+
+bool coref_fex::compatible(const SAMPLE &s1, const SAMPLE &s2, int filters) const{
+	// '0' is unknown, number 'n' and gender 'c' or 'n' are invariable
+	if ((filters & COREFEX_FILTER_NUMBER) && s1.number != s2.number
+	    && s1.number != '0' && s2.number != '0' && s1.number != 'n' && s2.number != 'n')
+		return false;
+	if ((filters & COREFEX_FILTER_GENDER) && s1.gender != s2.gender
+	    && s1.gender != '0' && s2.gender != '0' && s1.gender != 'c' && s2.gender != 'c'
+	    && s1.gender != 'n' && s2.gender != 'n')
+		return false;
+	return true;
+}
+
+
+void coref_fex::extract(EXAMPLE &ex, std::vector<int> &result){
+	set_mention_features(ex.sample1);
+	set_mention_features(ex.sample2);
+	extract(ex.sample1, ex.sample2, ex.sent, result);
+}
+
+
+void coref_fex::extract(const SAMPLE &s1, const SAMPLE &s2, std::vector<int> &result){
+	extract(s1, s2, s2.sent - s1.sent, result);
+}
+
+
+void coref_fex::extract(const SAMPLE &s1, const SAMPLE &s2, int sent, std::vector<int> &result){
+	result.clear();
+
+	if (vectors & COREFEX_DIST){
+		result.push_back(get_dist(sent));
+		result.push_back(get_numdedist(s1, s2));
+		result.push_back(get_dedist(s1, s2));
+	}
+
+	// features of each mention alone, computed once per mention
+	result.insert(result.end(), s1.feats1.begin(), s1.feats1.end());
+	result.insert(result.end(), s2.feats2.begin(), s2.feats2.end());
+
+	if (vectors & COREFEX_STRMATCH)
+		put_feature(get_str_match(s1, s2), result);
 	if (vectors & COREFEX_NUMBER)
-		put_feature(get_number(ex), result);
+		put_feature(get_number(s1, s2), result);
 	if (vectors & COREFEX_GENDER)
-		put_feature(get_gender(ex), result);
+		put_feature(get_gender(s1, s2), result);
 	if (vectors & COREFEX_SEMCLASS)
-		put_feature(get_semclass(ex), result);
+		put_feature(get_semclass(s1, s2), result);
 	if (vectors & COREFEX_PROPNAME)
-		put_feature(get_proper_name(ex), result);
+		put_feature(get_proper_name(s1, s2), result);
 
 	if (vectors & COREFEX_ALIAS) {
-		put_feature(get_alias_acro(ex), result);
-		put_feature(get_alias_fixleft(ex), result);
-		put_feature(get_alias_fixright(ex), result);
-		put_feature(get_alias_order(ex), result);
+		put_feature(get_alias_acro(s1, s2), result);
+		put_feature(get_alias_fixleft(s1, s2), result);
+		put_feature(get_alias_fixright(s1, s2), result);
+		put_feature(get_alias_order(s1, s2), result);
 	}
 
 	if (vectors & COREFEX_APPOS)
-		put_feature(get_appositive(ex), result);
-
-	put_feature(get_i_inquotes(ex), result);
-	put_feature(get_j_inquotes(ex), result);
-	put_feature(get_i_inparenthesis(ex), result);
-	put_feature(get_j_inparenthesis(ex), result);
-
-	put_feature(get_i_thirtperson(ex), result);
-	put_feature(get_j_thirtperson(ex), result);
-
+		put_feature(get_appositive(s1, s2), result);
 }
 
 //////////////////////////////////////////////////////////////////
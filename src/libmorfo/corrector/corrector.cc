@@ -62,7 +62,12 @@ corrector::corrector(const std::string &configfile, dictionary &mydict): diction
   MaxSizeDiff=3;
   distanceMethod=PHONETIC_DISTANCE;
   noDictionaryCheck=true;
+  useDeletions=false;
+  MaxEditDistance=2;
+  sm=NULL;
+  phd=NULL;
 
+  size_t sound_cache=10000;
   string ph_rules_file, wd_sound_dict, sampa_file, ph_dist_file;
 
   // load list of functional words that may be included in a NE.
@@ -81,6 +86,8 @@ corrector::corrector(const std::string &configfile, dictionary &mydict): diction
 	sin>>SimThresholdUnknownLow;
       else if (key=="MaxSizeDiff") 
 	sin>>MaxSizeDiff;
+      else if (key=="SoundCacheSize") 
+	sin>>sound_cache;
       else if (key=="CheckDictWords") {
 	sin>>value;
 	dictionaryCheck = RegEx(value);
@@ -94,6 +101,13 @@ corrector::corrector(const std::string &configfile, dictionary &mydict): diction
 	sin>>value;
 	similar_words.open_database(util::absolute(value,path));
       }
+      else if (key=="DeletionsDict") {
+	sin>>value;
+	deletions.open_database(util::absolute(value,path));
+	useDeletions=true;
+      }
+      else if (key=="MaxEditDistance") 
+	sin>>MaxEditDistance;
       else if (key=="PhoneticRules") {
 	sin>>ph_rules_file;
 	ph_rules_file=util::absolute(ph_rules_file,path);
@@ -132,14 +146,25 @@ corrector::corrector(const std::string &configfile, dictionary &mydict): diction
   }
   fabr.close(); 
 
+  if (useDeletions) {
+    // words further than the index depth would be silently missed
+    string depth=deletions.access_database(similarity::DELETION_DEPTH);
+    if (depth.empty())
+      WARNING("Deletion index has no depth. It may need to be rebuilt with dicc2phon.");
+    else if (MaxEditDistance>util::string2int(depth)) {
+      WARNING("MaxEditDistance can't be larger than the depth of the deletion index ("+depth+"). Lowered.");
+      MaxEditDistance=util::string2int(depth);
+    }
+  }
+
   if (SimThresholdUnknownHigh<SimThresholdUnknownLow) {
     WARNING("SimilarityThresholdUnknownHigh can't be lower than SimThresholdUnknownLow. Ignored");
     SimThresholdUnknownHigh=SimThresholdUnknownLow;
   }
 
-  ph= new phonetics(ph_rules_file, wd_sound_dict, sampa_file, useSoundDict);
+  ph= new phonetics(ph_rules_file, wd_sound_dict, sampa_file, useSoundDict, sound_cache);
 
-  if (distanceMethod==EDIT_DISTANCE) sm= new similarity();
+  if (distanceMethod==EDIT_DISTANCE or useDeletions) sm= new similarity();
   else if (distanceMethod==PHONETIC_DISTANCE) phd= new phoneticDistance(ph_dist_file);
 
   dict=&mydict;
@@ -155,9 +180,11 @@ corrector::corrector(const std::string &configfile, dictionary &mydict): diction
 corrector::~corrector(){
   // close the database
   similar_words.close_database();
+  if (useDeletions) deletions.close_database();
   // delete dict;
   delete ph;
   delete phd;
+  delete sm;
 }
 
 
@@ -182,38 +209,83 @@ string corrector:: getKey(string word){
 }
 
 
+////////////////////////////////////////////////////////////////////////
+/// returns the dictionary words within MaxEditDistance of given word.
+/// They are retrieved from the deletion index with each string obtained
+/// deleting up to MaxEditDistance chars of the word, and then checked.
+////////////////////////////////////////////////////////////////////////
+
+set<string> corrector::getNeighbours(const string &form) {
+
+  set<string> dels;
+  similarity::getDeletions(form,MaxEditDistance,dels);
+
+  set<string> checked,result;
+  for (set<string>::const_iterator d=dels.begin(); d!=dels.end(); d++) {
+    string data=deletions.access_database(d->empty() ? similarity::EMPTY_DELETION : *d);
+    if (data.empty()) continue;
+
+    list<string> cands=util::string2list(data,",");
+    for (list<string>::const_iterator c=cands.begin(); c!=cands.end(); c++) {
+      if (checked.insert(*c).second and sm->getDistance(form,*c,MaxEditDistance)<=MaxEditDistance)
+	result.insert(*c);
+    }
+  }
+
+  TRACE(3,"   Found "+util::int2string(result.size())+" words within distance "+util::int2string(MaxEditDistance));
+  return result;
+}
+
+
 ////////////////////////////////////////////////////////////////////////
 /// adds the new words that are posible correct spellings from original 
 /// word to the word analysys data
 ////////////////////////////////////////////////////////////////////////
 
-void corrector:: putWords(string listaPal, word &w) {
+void corrector:: putWords(list<string> &tokens, word &w) {
 
-  list<string> tokens = util::string2list(listaPal,",");
   string wform = util::lowercase(w.get_form());
 
+  // sound of the query word and its self-similarity (used to normalize
+  // candidate scores) are needed only once
+  string word1;
+  double simMax=1.0;
+  if (distanceMethod==PHONETIC_DISTANCE) {
+    word1=ph->getSound(wform);
+    simMax=(double) phd->getPhoneticDistance(word1,word1);
+  }
+
   int na=w.get_n_analysis();
   
   bool found=false;
   list<pair<word,double> > lalt;
   list<string>::iterator wd;  
   for( wd=tokens.begin(); wd!=tokens.end(); wd++) {
-    
+
+    // database entries may be "form|sound" if dicc2phon was asked to 
+    // precompute candidate sounds. Precomputed sounds are not valid if
+    // a sound dictionary is used, since dicc2phon does not use it.
+    string word2;
+    string::size_type bar=wd->find('|');
+    if (bar!=string::npos) {
+      if (!useSoundDict) word2=wd->substr(bar+1);
+      wd->erase(bar);
+    }
+
     int diff = wform.size() - wd->size();
     if (diff<0) diff = -diff;
 
     if (diff<MaxSizeDiff && wform!=(*wd)) { // do not repeat analysis in dict for a known form
       double simil=0.0;      
       if (distanceMethod==EDIT_DISTANCE) {
-	simil=(double) sm->getSimilarity(wform,*wd);	
+	// computation is abandoned as soon as the threshold can not be reached
+	simil=(double) sm->getSimilarity(wform,*wd, na? SimThresholdKnown : SimThresholdUnknownLow);	
 	TRACE(4,"   Simil "+util::double2string(simil)+" for ("+wform+") vs ("+(*wd)+")");
       }
       else if (distanceMethod==PHONETIC_DISTANCE) { // phonetic distance	
-	string word1=ph->getSound(wform);
-	string word2=ph->getSound(*wd);
+	if (word2.empty()) word2=ph->getSound(*wd);
 
 	simil=(double) phd->getPhoneticDistance(word1,word2);
-	double simMax=(double) phd->getPhoneticDistance(word1,word1);
 	simil=simil/simMax;	
 	TRACE(4,"   Simil "+util::double2string(simil)+" for ("+wform+","+word1+") vs ("+(*wd)+","+word2+")");
       }
@@ -273,7 +345,13 @@ void corrector:: annotate(sentence &se)
 		      
     TRACE(3,"Checking word "+pos->get_form()+": "+(spellCheck?"yes":"no"));
 
-    if (spellCheck){
+    if (spellCheck && useDeletions) {
+      // candidates are the dictionary words close enough to the form
+      set<string> neighbours=getNeighbours(util::lowercase(pos->get_form()));
+      list<string> cands(neighbours.begin(),neighbours.end());
+      if (cands.size()>0) putWords(cands,*pos);
+    }
+    else if (spellCheck){
       string listaPal;
       // calculate the sound without vowels of the current word
       string key = getKey(pos->get_form()); 
@@ -285,7 +363,10 @@ void corrector:: annotate(sentence &se)
 	TRACE(3,"   Obtained words: ["+listaPal+"]");
 
 	// filter and add the obtained words as new analysis
-	if (listaPal.size()>0) putWords(listaPal,*pos); 
+	if (listaPal.size()>0) {
+	  list<string> cands=util::string2list(listaPal,",");
+	  putWords(cands,*pos); 
+	}
       }
     }
   }  
@@ -35,14 +35,10 @@ phoneticDistance::~phoneticDistance(){
 ///  Returns the phonetic distance between two words 
 ///////////////////////////////////////////////////////////////
 
-int phoneticDistance::getPhoneticDistance(string word1, string word2){
+int phoneticDistance::getPhoneticDistance(const string &word1, const string &word2){
    	
-  char* a=(char *) word1.c_str();
-  char* b=(char *) word2.c_str();
-  aligner<int>::alin* result = al->align(a,strlen(a),b,strlen(b),GLOBAL);
-  int resultado=result->score;
-  delete(result);
+  // only the score is needed, no need to build the alignment
+  int resultado = al->align_score(word1.c_str(),word1.size(),word2.c_str(),word2.size(),ws);
   TRACE(4,"word1: "+word1+" word2: "+word2+" result: "+util::int2string(resultado));
   return resultado;
 }
-
@@ -58,12 +58,15 @@ string chomp (string e){
 ///  Create the phonetic translator
 ///////////////////////////////////////////////////////////////
 
-phonetics::phonetics(string rulesFileIn, string dictFileIn, string sampaFileIn, bool useDictIn) {
+phonetics::phonetics(string rulesFileIn, string dictFileIn, string sampaFileIn, bool useDictIn, size_t cacheSizeIn) {
 
   string rulesFile=rulesFileIn;
   string dictFile=dictFileIn;
   string sampaFile=sampaFileIn;
   useDict=useDictIn;
+  cacheSize=cacheSizeIn;
+  pthread_mutex_init(&lock,NULL);
+  pthread_mutex_init(&sc_lock,NULL);
   
   
   // loading rules
@@ -159,41 +162,67 @@ phonetics::phonetics(string rulesFileIn, string dictFileIn, string sampaFileIn,
 
 phonetics::~phonetics(){
   delete sc;
+  pthread_mutex_destroy(&sc_lock);
+  pthread_mutex_destroy(&lock);
  
 }
 
 
 /////////////////////////////////////////////////////////////////////////////
-/// getSound return the phonetic translation of a word
+/// getSound return the phonetic translation of a word.
+/// Translations are kept in a cache of at most cacheSize words. When
+/// it is full, the least recently used entry is dropped. The cache and
+/// the sound changer have separate locks, so the same object may be
+/// used from several threads, and cache hits do not wait for the 
+/// translation of other words.
 /////////////////////////////////////////////////////////////////////////////
-string phonetics::getSound(string word){
-  
-  string form=word;
-  string form1=form;
-  string sound;
+
+string phonetics::getSound(const string &form1){
   
   if (form1.empty()) return "";
-  sound=DIC[form1];
-  if (useDict and !sound.empty()) { return sound;}
-  else {
-    string aux=cache[form1];
-    if (aux.empty()){	
-      sound=sc->change(form1);
-      TRACE(4,"soundChange returns: "+sound+" from word "+form1);
-      string result;
-      for (size_t i=0; i<sound.size(); i++) {
-	string it=sound.substr(i,1);
-	string res=SAMPA[it];
-	result=result+res;
+
+  if (useDict) {
+    map<string,string>::const_iterator d=DIC.find(form1);
+    if (d!=DIC.end() and !d->second.empty()) return d->second;
+  }
+
+  if (cacheSize>0) {
+    pthread_mutex_lock(&lock);
+    map<string,pair<string,list<string>::iterator> >::iterator c=cache.find(form1);
+    if (c!=cache.end()) {
+      // move to the most recently used end
+      cache_order.splice(cache_order.end(), cache_order, c->second.second);
+      string sound=c->second.first;
+      pthread_mutex_unlock(&lock);
+      return sound;
+    }
+    pthread_mutex_unlock(&lock);
+  }
+
+  pthread_mutex_lock(&sc_lock);
+  string sound=sc->change(form1);
+  pthread_mutex_unlock(&sc_lock);
+  TRACE(4,"soundChange returns: "+sound+" from word "+form1);
+  string result;
+  for (size_t i=0; i<sound.size(); i++) {
+    map<string,string>::const_iterator it=SAMPA.find(sound.substr(i,1));
+    if (it!=SAMPA.end()) result += it->second;
+  }
+  TRACE(4,"sampa translation converts "+sound+" into "+result);
+
+  if (cacheSize>0) {
+    pthread_mutex_lock(&lock);
+    // another thread may have added it meanwhile
+    if (cache.find(form1)==cache.end()) {
+      if (cache.size()>=cacheSize) {
+        cache.erase(cache_order.front());
+        cache_order.pop_front();
       }
-      TRACE(4,"sampa translation converts "+sound+" into "+result);
-      sound=result;
-      cache[form1]=sound;
+      cache_order.push_back(form1);
+      cache.insert(make_pair(form1,make_pair(result,--cache_order.end())));
     }
-    //Set
-    sound=cache[form1];
+    pthread_mutex_unlock(&lock);
   }
-  
-  return sound;
-  
+
+  return result;
 }
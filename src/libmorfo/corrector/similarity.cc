@@ -21,51 +21,91 @@ similarity::~similarity(){}
 
 
 ///////////////////////////////////////////////////////////////
-///  Returns simple edit distance between two strings
+///  Returns simple edit distance between two strings, using
+///  Myers' bit-parallel algorithm (in Hyyro's formulation for
+///  Levenshtein distance). The shorter string is encoded as bit
+///  vectors, in blocks of 64 characters, so any length is handled,
+///  and the other is scanned once.  If maxdist is not negative, the
+///  computation stops as soon as the distance is known to be larger
+///  than maxdist, and some value above maxdist is returned.
 ///////////////////////////////////////////////////////////////
 
-int similarity::ComputeDistance(string s, string t)
+int similarity::ComputeDistance(const string &s, const string &t, int maxdist)
 {
-  int n=s.size();
-  int m=t.size();
-  int distance[50][50]; // matrix
-  
-  int cost=0;
-  if(n == 0) return m;
-  if(m == 0) return n;
-  //init1
-  
-  int i=0;
-  int j=0;
-  for(i=0; i <= n; i++) distance[i][0]=i;
-  for(j=0; j <= m; j++) distance[0][j]=j;
-  //find min distance
-  
-  for(i=1; i <= n; i++){
-    for(j=1; j <= m;j++){
-      cost=(t.substr(j - 1, 1) == 
-	    s.substr(i - 1, 1) ? 0 : 1);
-      // distance[i][j]=Min3(distance[i - 1][j] + 1,distance[i][j - 1] + 1,distance[i - 1][j - 1] + cost);
-      int valor[3];
-      valor[0]=distance[i - 1][j] + 1;
-      valor[1]=distance[i][j - 1] + 1;
-      valor[2]=distance[i - 1][j - 1] + cost;
-      int minimo=valor[0];
-      for (int indice=1;indice<3;indice++)
-	{	
-	  if (minimo>valor[indice]) {minimo=valor[indice];}
-	}
-      distance[i][j]=minimo;
+  typedef unsigned long long bits;
+  const int W=64;
+
+  // pattern is the shorter string
+  const string &p = (s.size()<=t.size() ? s : t);
+  const string &x = (s.size()<=t.size() ? t : s);
+  int m=p.size();
+  int n=x.size();
+
+  if (maxdist>=0 && n-m>maxdist) return n-m;
+  if (m == 0) return n;
+
+  int nb=(m+W-1)/W;
+  if ((int)vp.size()<nb) {
+    peq.resize(256*nb,0);
+    vp.resize(nb);
+    vn.resize(nb);
+  }
+
+  // build pattern masks.
+  for (int i=0; i<m; i++) 
+    peq[(unsigned char)p[i]*nb + i/W] |= ((bits)1)<<(i%W);
+
+  for (int b=0; b<nb; b++) { vp[b]=~((bits)0); vn[b]=0; }
+
+  const bits high = ((bits)1)<<(W-1);
+  const bits last = ((bits)1)<<((m-1)%W);
+  int score=m;
+
+  for (int j=0; j<n; j++) {
+    const bits *eqc = &peq[(unsigned char)x[j]*nb];
+    // horizontal delta entering the first block: row 0 grows by one
+    int hin=1;
+    for (int b=0; b<nb; b++) {
+      bits pv=vp[b], mv=vn[b];
+      bits eq=eqc[b];
+      bits xv = eq | mv;
+      if (hin<0) eq |= 1;
+      bits xh = (((eq & pv) + pv) ^ pv) | eq;
+      bits ph = mv | ~(xh | pv);
+      bits mh = pv & xh;
+
+      bits top = (b==nb-1 ? last : high);
+      int hout = (ph & top) ? 1 : ((mh & top) ? -1 : 0);
+
+      ph <<= 1; mh <<= 1;
+      if (hin<0) mh |= 1;
+      else if (hin>0) ph |= 1;
+
+      vp[b] = mh | ~(xv | ph);
+      vn[b] = ph & xv;
+      hin=hout;
+    }
+    score += hin;
+
+    // the bottom row can decrease at most by one per remaining column
+    if (maxdist>=0 && score-(n-j-1)>maxdist) {
+      score -= n-j-1;
+      break;
     }
   }
-  return distance[n][m];
+
+  // leave pattern masks clean for next call
+  for (int i=0; i<m; i++) 
+    peq[(unsigned char)p[i]*nb + i/W] = 0;
+
+  return score;
 }
 
 ///////////////////////////////////////////////////////////////
 ///  Returns the similarity between two words 
 ///////////////////////////////////////////////////////////////
 
-float similarity::getSimilarity(string word1, string word2){  
+float similarity::getSimilarity(const string &word1, const string &word2){  
   
   float dis=ComputeDistance(word1, word2);
   float maxLen=word1.size();
@@ -77,3 +117,65 @@ float similarity::getSimilarity(string word1, string word2){
     return 1.0F - dis/maxLen; 
 }
 
+///////////////////////////////////////////////////////////////
+///  Returns the similarity between two words if it is above minsim.
+///  Otherwise, the distance computation is abandoned as soon as the 
+///  threshold can not be reached, and a value not above minsim is 
+///  returned.
+///////////////////////////////////////////////////////////////
+
+float similarity::getSimilarity(const string &word1, const string &word2, float minsim){  
+
+  float maxLen=word1.size();
+  if (maxLen < word2.size())
+    maxLen = word2.size();
+  if (maxLen == 0.0F)
+    return 1.0F;
+
+  // similarity is above minsim iff distance is below (1-minsim)*maxLen.
+  // One unit of slack makes sure any returned value past the bound is 
+  // at least one unit larger, and thus its similarity is not above minsim.
+  int maxdist = int((1.0F-minsim)*maxLen) + 1;
+  if (maxdist<0) maxdist=0;
+
+  float dis=ComputeDistance(word1, word2, maxdist);
+  return 1.0F - dis/maxLen; 
+}
+
+///////////////////////////////////////////////////////////////
+///  Returns the edit distance between two words, or some value
+///  above maxdist as soon as it is known to exceed it.
+///////////////////////////////////////////////////////////////
+
+int similarity::getDistance(const string &word1, const string &word2, int maxdist){  
+  return ComputeDistance(word1, word2, maxdist);
+}
+
+///////////////////////////////////////////////////////////////
+///  Adds to the set all strings obtained deleting up to k chars
+///  of the word, including the word itself.  Two words are within
+///  edit distance k only if their deletion sets intersect, so these
+///  strings are used to index and retrieve correction candidates.
+///////////////////////////////////////////////////////////////
+
+const string similarity::EMPTY_DELETION="<empty>";
+const string similarity::DELETION_DEPTH="<depth>";
+
+void similarity::getDeletions(const string &word, int k, set<string> &dels) {
+
+  dels.insert(word);
+
+  set<string> last, next;
+  last.insert(word);
+  for (int d=0; d<k; d++) {
+    next.clear();
+    for (set<string>::const_iterator v=last.begin(); v!=last.end(); v++) {
+      for (size_t i=0; i<v->size(); i++) {
+	string del=*v;
+	del.erase(i,1);
+	if (dels.insert(del).second) next.insert(del);
+      }
+    }
+    last.swap(next);
+  }
+}
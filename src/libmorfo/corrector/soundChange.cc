@@ -70,6 +70,29 @@ soundChange::soundChange(const map<string,string> &vars, const vector<string> &r
 	util::find_and_replace(newrule.env, var, val);	
       }
 
+      // Precompute what the rule changes. A rule from a sound to itself 
+      // changes nothing, category rules are applied char by char.
+      newrule.category = (newrule.from[0]=='[');
+      if (newrule.category) {
+	newrule.fchars=newrule.from.substr(1,newrule.from.size()-2);
+	if (newrule.to.size()>1) newrule.tchars=newrule.to.substr(1,newrule.to.size()-2);
+	else {
+	  newrule.tchars=newrule.to;
+	  for (size_t ii=newrule.tchars.size();ii<newrule.fchars.size();ii++) { // @ to @@@@@@@@@@@@@@ so change aeiou to @@@@@
+	    newrule.tchars=newrule.tchars+newrule.tchars.substr(0,1);
+	  }
+	}
+      }
+
+      // compile the environment condition once: the "_" sign stands for the
+      // searched string
+      newrule.conditional = (newrule.env.size()>1);
+      if (newrule.conditional) {
+	string pattern="("+newrule.env+")";
+	util::find_and_replace(pattern,"_","("+newrule.from+")"); 
+	newrule.cond = RegEx(pattern);
+      }
+
       // store the resulting rule.
       rules.push_back(newrule);
     }
@@ -105,27 +128,28 @@ string soundChange::change(const string &word) const {
 
 
 ///////////////////////////////////////////////////////////////
-///  check that the enviorment is true
+///  check that the enviorment is true. The first match of the 
+///  environment in the text is searched only once (first==-2 means
+///  "not searched yet") and kept in "first" until the text changes.
 ///////////////////////////////////////////////////////////////
 
-bool soundChange::check_cond(const string &text, const string &opt, int loc, const string &findStr) const {
+bool soundChange::check_cond(const string &text, const ph_rule &rul, int loc, int &first) const {
 	
-  if (opt.size()<=1) return true; // condition "_" always holds
-  
-  string pattern="("+opt+")";
-  util::find_and_replace(pattern,"_","("+findStr+")"); // we substitute _ for findStr
+  if (!rul.conditional) return true; // condition "_" always holds
   
-  RegEx re(pattern);
-  if (re.Search(text)){
-    int ini,fin;
-    re.MatchPositions(1,ini,fin);
-    if (ini!=-1) 
-      return (ini==loc); // the sign _ and the loc of the char to replace must be in te same location
-    else 
-      ERROR_CRASH("Error in MatchPositions");
+  if (first==-2) {
+    first=-1;
+    if (rul.cond.Search(text)){
+      int ini,fin;
+      rul.cond.MatchPositions(1,ini,fin);
+      if (ini!=-1) first=ini;
+      else 
+	ERROR_CRASH("Error in MatchPositions");
+    }
   }
 
-  return false; // no match  
+  // the sign _ and the loc of the char to replace must be in the same location
+  return (first!=-1 && first==loc); 
 }
 
 
@@ -138,44 +162,31 @@ string soundChange::apply_rule(const string &text, const ph_rule &rul) const {
   
   size_t j;
   string result=text;
+  int first=-2;  // environment match not searched yet
   
-  if ((rul.from.substr(0,1)!="[") and (rul.from!=rul.to)) {
-    for (int x=0;(j = result.find(rul.from,x)) != string::npos ;) {
-      if (check_cond(result,rul.env,j,rul.from)){
-	string auxtext=result;
-	result.erase(j, rul.from.size());
-	result.insert(j, rul.to);
-	
-      }
-      if (j!=string::npos ){
-	if (rul.to.size()>0) x=j+rul.to.size();
-	else x=j+1;
-	
+  if (!rul.category) {
+    if (rul.from==rul.to) return result;
+
+    for (size_t x=0; (j = result.find(rul.from,x)) != string::npos; ) {
+      if (check_cond(result,rul,j,first)){
+	result.replace(j, rul.from.size(), rul.to);
+	first=-2;
       }
-      else break;
+      if (rul.to.size()>0) x=j+rul.to.size();
+      else x=j+1;
     }
   }
   else {
-    string f=rul.from.substr(1,rul.from.size()-2);
-    string r;
-    if (rul.to.size()>1) r=rul.to.substr(1,rul.to.size()-2);
-    else {
-      r=rul.to;
-      for (size_t ii=r.size();ii<f.size();ii++)	{ // @ to @@@@@@@@@@@@@@ so change aeiou to @@@@@
-	r=r+r.substr(0,1);
-      }			
-    }
+    const string &f=rul.fchars;
+    const string &r=rul.tchars;
     for (size_t z=0;z<f.size();z++){
       if (f.at(z)!=r.at(z)){	
-	string cc=f.substr(z,1);
-	for (int x=0; (j = result.find(cc,x)) != string::npos ; ) {
-	  if (check_cond(result,rul.env,j,rul.from)){
-	    string auxtext=result;
-	    result.erase(j,1);
-	    result.insert(j, r.substr(z,1));
+	for (size_t x=0; (j = result.find(f[z],x)) != string::npos; ) {
+	  if (check_cond(result,rul,j,first)){
+	    result[j]=r[z];
+	    first=-2;
 	  }
-	  if (j!=string::npos ) x=j+1;
-	  else break;
+	  x=j+1;
 	}
       }
     }
@@ -30,6 +30,7 @@
 #include <fstream>
 
 #include "freeling/database.h"
+#include "fries/util.h"
 #include "freeling/traces.h"
 
 using namespace std;
@@ -42,9 +43,9 @@ using namespace std;
 ///////////////////////////////////////////////////////////////
 
 #ifdef USE_LIBDB
-database::database() : Db(NULL,DB_CXX_NO_EXCEPTIONS) {}
+database::database() : Db(NULL,DB_CXX_NO_EXCEPTIONS), filter_bits(0), filter_hashes(0) {}
 #else
-database::database() {}
+database::database() : filter_bits(0), filter_hashes(0) {}
 #endif
 
 ///////////////////////////////////////////////////////////////
@@ -125,8 +126,6 @@ string database::access_database(const string &clau) {
 
     #ifdef USE_LIBDB
       int error;
-      char buff[1024];
-      unsigned int p;
       Dbt data, key;
       
       // Access the DB
@@ -136,12 +135,8 @@ string database::access_database(const string &clau) {
       
       list<string> lsen;
       if (!error) {  // key found
-	// copy the data associated to the key to the buffer
-	p=data.get_size();
-	memcpy((void *)buff, data.get_data(), p);
-	
-	// convert char* to string into data_string
-	buff[p]=0; data_string=buff;    
+	// copy the data associated to the key (may be long, e.g. in deletion indices)
+	data_string.assign((const char *)data.get_data(), data.get_size());
       }
       else if (error == DB_NOTFOUND) {
 	data_string="";
@@ -163,4 +158,100 @@ string database::access_database(const string &clau) {
   return data_string;
 }
 
+///////////////////////////////////////////////////////////////
+///  Compute two independent 32-bit hashes of a key (FNV-1a and 
+///  a multiplicative one), combined to get the filter positions.
+///////////////////////////////////////////////////////////////
+
+void database::hash_key(const string &clau, unsigned int &h1, unsigned int &h2) {
+
+  h1=2166136261U; h2=0;
+  for (string::const_iterator c=clau.begin(); c!=clau.end(); c++) {
+    h1 = (h1 ^ (unsigned char)(*c)) * 16777619U;
+    h2 = h2*31 + (unsigned char)(*c);
+  }
+  // mix h2 bits, and make it odd so that, the filter size being a
+  // power of two, all positions are reachable
+  h2 ^= h2>>16; h2 *= 0x85ebca6bU; h2 ^= h2>>13;
+  h2 |= 1;
+}
+
+///////////////////////////////////////////////////////////////
+///  Build a Bloom filter over all keys in the database, to
+///  quickly discard searches for keys that are not there.
+///  All keys are read, so this takes time proportional to the
+///  size of the database.
+///////////////////////////////////////////////////////////////
+
+void database::build_filter(unsigned int bits_per_key) {
+
+  // collect the hashes of all keys, so they are read only once
+  vector<pair<unsigned int,unsigned int> > hashes;
+  unsigned int h1,h2;
+
+  if (usingDB) {
+    #ifdef USE_LIBDB
+      Dbc *cursor;
+      Dbt key, data;
+      int error;
+      if ((error=this->cursor(NULL,&cursor,0))) {
+        ERROR_CRASH("Error '"+string(db_strerror(error))+"' while accessing database");
+      }
+      while ((error=cursor->get(&key,&data,DB_NEXT))==0) {
+        hash_key(string((const char *)key.get_data(),key.get_size()),h1,h2);
+        hashes.push_back(make_pair(h1,h2));
+      }
+      cursor->close();
+      if (error!=DB_NOTFOUND) {
+        ERROR_CRASH("Error '"+string(db_strerror(error))+"' while accessing database");
+      }
+    #else
+      ERROR_CRASH("BerkeleyDB support was not compiled in this FreeLing installation.");
+    #endif
+  }
+  else {
+    for (map<string,string>::const_iterator p=dbmap.begin(); p!=dbmap.end(); p++) {
+      hash_key(p->first,h1,h2);
+      hashes.push_back(make_pair(h1,h2));
+    }
+  }
+
+  // optimal number of hashes for given filter size is bits_per_key*ln(2)
+  filter_hashes = (bits_per_key*693+500)/1000;
+  if (filter_hashes<1) filter_hashes=1;
+  // size is a power of two (and at least one word), so positions
+  // are obtained with a mask
+  filter_bits = 32;
+  while (filter_bits < hashes.size()*bits_per_key) filter_bits <<= 1;
+  filter.assign(filter_bits/32, 0);
+
+  for (vector<pair<unsigned int,unsigned int> >::const_iterator h=hashes.begin(); h!=hashes.end(); h++) {
+    h1=h->first;
+    for (unsigned int i=0; i<filter_hashes; i++) {
+      unsigned int b = h1 & (filter_bits-1);
+      filter[b/32] |= (1U << (b%32));
+      h1 += h->second;
+    }
+  }
 
+  TRACE(3,"Filter built for "+util::int2string(hashes.size())+" keys");
+}
+
+///////////////////////////////////////////////////////////////
+///  Check the filter for given key. False means the key is
+///  surely not in the database, true that it may be.
+///////////////////////////////////////////////////////////////
+
+bool database::may_contain(const string &clau) const {
+
+  if (filter.empty()) return true;
+
+  unsigned int h1,h2;
+  hash_key(clau,h1,h2);
+  for (unsigned int i=0; i<filter_hashes; i++) {
+    unsigned int b = h1 & (filter_bits-1);
+    if (not (filter[b/32] & (1U << (b%32)))) return false;
+    h1 += h2;
+  }
+  return true;
+}
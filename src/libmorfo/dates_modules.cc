@@ -42,6 +42,15 @@ using namespace std;
 dates_module::dates_module(const std::string &rd, const std::string &rt1, const std::string &rt2, const std::string &rtrom): automat(), RE_Date(rd), RE_Time1(rt1), RE_Time2(rt2), RE_Roman(rtrom)
 {}
 
+// Bits to store regex results in word classification.
+// All date and time regexes require some digit in the form,
+// so they are only run on forms containing one.
+#define RX_DATE   1   // form matches RE_DATE
+#define RX_TIME1  2   // form matches RE_TIME1
+#define RX_HHMM   4   // form matches RE_TIME1, including minutes
+#define RX_TIME2  8   // form matches RE_TIME2
+#define RX_ROMAN 16   // original form matches RE_ROMAN
+
 //-----------------------------------------------//
 //        Default date/time recognizer           //
 //        Only recognize simple patterns         //
@@ -75,10 +84,6 @@ dates_default::dates_default(): dates_module(RE_DATE_DF, RE_TIME1_DF, RE_TIME2_D
   // Initialize Final state set 
   Final.insert(B); Final.insert(C); Final.insert(D);
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-
   // State A
   trans[A][TK_date]=B;
   // State B
@@ -100,19 +105,19 @@ dates_default::dates_default(): dates_module(RE_DATE_DF, RE_TIME1_DF, RE_TIME2_D
 
 int dates_default::ComputeToken(int state, sentence::iterator &j, sentence &se)
 {
-  string form,formU;
   int token;
 
-  formU = j->get_form();
-  form = util::lowercase(formU);
+  // get word classification (computed once per sentence)
+  token_class &tc=classify(j);
+  const string &form=tc.lcform;
 
   token = TK_other;
-  if (RE_Date.Search(form)) {
-    TRACE(3,"Match DATE regex. "+RE_Date.Match(0));
+  if (tc.digit && check_regex(j,RX_DATE,RE_Date)) {
+    TRACE(3,"Match DATE regex. "+form);
     token = TK_date;
   }
-  else if (RE_Time1.Search(form)) {
-    if(RE_Time1.Match(2)!=""){
+  else if (tc.digit && check_regex(j,RX_TIME1,RE_Time1)) {
+    if(check_regex(j,RX_HHMM,RE_Time1,true,2)){
       TRACE(3,"Match TIME1 regex (hour+min)");
       token = TK_hhmm;
     }
@@ -121,7 +126,7 @@ int dates_default::ComputeToken(int state, sentence::iterator &j, sentence &se)
       token = TK_hour;
     }
   }
-  else if (RE_Time2.Search(form)) {
+  else if (tc.digit && check_regex(j,RX_TIME2,RE_Time2)) {
     TRACE(3,"Match TIME2 regex (minutes)");
     token = TK_min;
   }
@@ -393,10 +398,6 @@ dates_es::dates_es(): dates_module(RE_DATE_ES, RE_TIME1_ES, RE_TIME2_ES, RE_ROMA
   Final.insert(P);   Final.insert(S2);    Final.insert(BH);  Final.insert(BH2);  
   Final.insert(CH);  Final.insert(GH);     Final.insert(GH1); 
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-
   // State A
   trans[A][TK_weekday]=B;   trans[A][TK_wday]=D;   trans[A][TK_wmonth]=G;
   trans[A][TK_wyear]=K;     trans[A][TK_date]=L;     
@@ -523,12 +524,12 @@ dates_es::dates_es(): dates_module(RE_DATE_ES, RE_TIME1_ES, RE_TIME2_ES, RE_ROMA
 
 int dates_es::ComputeToken(int state, sentence::iterator &j, sentence &se)
 {
-  string form,formU;
   int token,value;
   map<string,int>::iterator im;
 
-  formU = j->get_form();
-  form = util::lowercase(formU);
+  // get word classification (computed once per sentence)
+  token_class &tc=classify(j);
+  const string &form=tc.lcform;
 
   token = TK_other;
   im = tok.find(form);
@@ -559,12 +560,12 @@ int dates_es::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=1 && value<=31 && form!="una" && form!="un") {
       token = TK_daynum;
     }
-    else if (RE_Date.Search(form)) {
-      TRACE(3,"Match DATE regex. "+RE_Date.Match(0));
+    else if (tc.digit && check_regex(j,RX_DATE,RE_Date)) {
+      TRACE(3,"Match DATE regex. "+form);
       token = TK_date;
     }
-    else if (RE_Time1.Search(form)) {
-      if(RE_Time1.Match(2)!=""){
+    else if (tc.digit && check_regex(j,RX_TIME1,RE_Time1)) {
+      if(check_regex(j,RX_HHMM,RE_Time1,true,2)){
 	TRACE(3,"Match TIME1 regex (hour+min)");
 	token = TK_hhmm;
       }
@@ -604,8 +605,8 @@ int dates_es::ComputeToken(int state, sentence::iterator &j, sentence &se)
     break;
   // --------------------------------
   case S1:
-    if (RE_Roman.Search(formU)) {
-      TRACE(3,"Match ROMAN regex. "+RE_Roman.Match(0));
+    if (tc.roman && check_regex(j,RX_ROMAN,RE_Roman,false)) {
+      TRACE(3,"Match ROMAN regex. "+j->get_form());
       token=TK_roman;
     }
     break;
@@ -615,8 +616,8 @@ int dates_es::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=0 && value<=24) {
       token = TK_hournum;
     }
-    else if (RE_Time1.Search(form)) {
-      if(RE_Time1.Match(2)!=""){
+    else if (tc.digit && check_regex(j,RX_TIME1,RE_Time1)) {
+      if(check_regex(j,RX_HHMM,RE_Time1,true,2)){
 	TRACE(3,"Match TIME1 regex (hour+min)");
 	token = TK_hhmm;
       }
@@ -633,7 +634,7 @@ int dates_es::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=0 && value<=60) {
       token=TK_minnum;
     }
-    else if (RE_Time2.Search(form)) {
+    else if (tc.digit && check_regex(j,RX_TIME2,RE_Time2)) {
       TRACE(3,"Match TIME2 regex (minutes)");
       token = TK_min;
     }    
@@ -647,7 +648,7 @@ int dates_es::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=0 && value<=60){
       token=TK_minnum;
     }
-    else if (RE_Time2.Search(form)) {
+    else if (tc.digit && check_regex(j,RX_TIME2,RE_Time2)) {
       TRACE(3,"Match TIME2 regex (minutes)");
       token = TK_min;
     }
@@ -1323,10 +1324,6 @@ dates_ca::dates_ca(): dates_module(RE_DATE_CA, RE_TIME1_CA, RE_TIME2_CA, RE_ROMA
   Final.insert(P);   Final.insert(S2);    Final.insert(BH);  Final.insert(BH2); 
   Final.insert(CH);  Final.insert(GH);    Final.insert(GH1); 
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-
   // State A
   trans[A][TK_weekday]=B;   trans[A][TK_wday]=D;       trans[A][TK_wmonth]=G;    
   trans[A][TK_wyear]=K;     trans[A][TK_date]=L;     
@@ -1492,12 +1489,12 @@ dates_ca::dates_ca(): dates_module(RE_DATE_CA, RE_TIME1_CA, RE_TIME2_CA, RE_ROMA
 
 int dates_ca::ComputeToken(int state, sentence::iterator &j, sentence &se)
 {
-  string form,formU;
   int token,value;
   map<string,int>::iterator im;
 
-  formU = j->get_form();
-  form = util::lowercase(formU);
+  // get word classification (computed once per sentence)
+  token_class &tc=classify(j);
+  const string &form=tc.lcform;
 
   token = TK_other;
   im = tok.find(form);
@@ -1528,12 +1525,12 @@ int dates_ca::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=0 && value<=31) {
       token = TK_daynum; // it can be a "quart" number, an hour number  or a day number
     }
-    else if (RE_Date.Search(form)) {
-      TRACE(3,"Match DATE regex. "+RE_Date.Match(0));
+    else if (tc.digit && check_regex(j,RX_DATE,RE_Date)) {
+      TRACE(3,"Match DATE regex. "+form);
       token = TK_date;
     }
-    else if (RE_Time1.Search(form)) {
-      if(RE_Time1.Match(2)!=""){
+    else if (tc.digit && check_regex(j,RX_TIME1,RE_Time1)) {
+      if(check_regex(j,RX_HHMM,RE_Time1,true,2)){
 	TRACE(3,"Match TIME1 regex (hour+min)");
 	token = TK_hhmm;
       }
@@ -1572,8 +1569,8 @@ int dates_ca::ComputeToken(int state, sentence::iterator &j, sentence &se)
     break;
   // --------------------------------
   case S1:
-    if (RE_Roman.Search(formU)) {
-      TRACE(3,"Match ROMAN regex. "+RE_Roman.Match(0));
+    if (tc.roman && check_regex(j,RX_ROMAN,RE_Roman,false)) {
+      TRACE(3,"Match ROMAN regex. "+j->get_form());
       token=TK_roman;
     }
     break;
@@ -1583,8 +1580,8 @@ int dates_ca::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=0 && value<=24) {
       token = TK_hournum;
     }
-    else if (RE_Time1.Search(form)) {
-      if(RE_Time1.Match(2)!=""){
+    else if (tc.digit && check_regex(j,RX_TIME1,RE_Time1)) {
+      if(check_regex(j,RX_HHMM,RE_Time1,true,2)){
 	TRACE(3,"Match TIME1 regex (hour+min)");
 	token = TK_hhmm;
       }
@@ -1601,7 +1598,7 @@ int dates_ca::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=0 && value<=60) {
       token=TK_minnum;
     }
-    else if (RE_Time2.Search(form)) {
+    else if (tc.digit && check_regex(j,RX_TIME2,RE_Time2)) {
       TRACE(3,"Match TIME2 regex (minutes)");
       token = TK_min;
     }    
@@ -1615,7 +1612,7 @@ int dates_ca::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=0 && value<=60) {
       token=TK_minnum;
     }
-    else if (RE_Time2.Search(form)) {
+    else if (tc.digit && check_regex(j,RX_TIME2,RE_Time2)) {
       TRACE(3,"Match TIME2 regex (minutes)");
       token = TK_min;
     }
@@ -1636,7 +1633,7 @@ int dates_ca::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>0 && value<15) { // "i cinc, i deu..."
       token=TK_minnum;
     }
-    else if (RE_Time2.Search(form)) {
+    else if (tc.digit && check_regex(j,RX_TIME2,RE_Time2)) {
       TRACE(3,"Match TIME2 regex (minutes)");
       token = TK_min;
     }
@@ -1648,8 +1645,8 @@ int dates_ca::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=0 && value<=24) {
       token = TK_hournum;
     }
-    else if (RE_Time1.Search(form)) {
-      if(RE_Time1.Match(2)==""){
+    else if (tc.digit && check_regex(j,RX_TIME1,RE_Time1)) {
+      if(not check_regex(j,RX_HHMM,RE_Time1,true,2)){
 	TRACE(3,"Partial match TIME1 regex (hour)");
 	token = TK_hour;
       }	      
@@ -2423,10 +2420,6 @@ dates_en::dates_en(): dates_module(RE_DATE_EN, RE_TIME1_EN, RE_TIME2_EN, RE_ROMA
   Final.insert(AH);  Final.insert(CH);    Final.insert(GH);    Final.insert(EH); 
   Final.insert(EHb); Final.insert(AH1);   Final.insert(GH1);   Final.insert(EH1);
 
-  // Initialize transition table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-
   // State A
   trans[A][TK_weekday]=B;   trans[A][TK_wday]=D;   trans[A][TK_wmonth]=G;
   trans[A][TK_wyear]=K;     trans[A][TK_win]=J;    trans[A][TK_date]=L;     
@@ -2613,12 +2606,12 @@ dates_en::dates_en(): dates_module(RE_DATE_EN, RE_TIME1_EN, RE_TIME2_EN, RE_ROMA
 ///////////////////////////////////////////////////////////////
 int dates_en::ComputeToken(int state, sentence::iterator &j, sentence &se)
 {
-  string form,formU;
   int token,value;
   map<string,int>::iterator im;
 
-  formU = j->get_form();
-  form = util::lowercase(formU);
+  // get word classification (computed once per sentence)
+  token_class &tc=classify(j);
+  const string &form=tc.lcform;
 
   token = TK_other;
   im = tok.find(form);
@@ -2669,12 +2662,12 @@ int dates_en::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=0 && value<=59) {
         token = TK_minnum; // it can also be an hournum
     }
-    else if (RE_Date.Search(form)) {
-      TRACE(3,"Match DATE regex. "+RE_Date.Match(0));
+    else if (tc.digit && check_regex(j,RX_DATE,RE_Date)) {
+      TRACE(3,"Match DATE regex. "+form);
       token = TK_date;
     }
-    else if (RE_Time1.Search(form)) {
-      if(RE_Time1.Match(2)!=""){
+    else if (tc.digit && check_regex(j,RX_TIME1,RE_Time1)) {
+      if(check_regex(j,RX_HHMM,RE_Time1,true,2)){
 	TRACE(3,"Match TIME1 regex (hour+min)");
 	token = TK_hhmm;
       }
@@ -2683,7 +2676,7 @@ int dates_en::ComputeToken(int state, sentence::iterator &j, sentence &se)
 	token = TK_hour;
       }	 
     }
-    else if (RE_Time2.Search(form)) 
+    else if (tc.digit && check_regex(j,RX_TIME2,RE_Time2)) 
       token = TK_min;
 	
     break;
@@ -2695,12 +2688,12 @@ int dates_en::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=0 && value<=31){
       token = TK_daynum;
     }
-    else if (RE_Date.Search(form)) {
-      TRACE(3,"Match DATE regex. "+RE_Date.Match(0));
+    else if (tc.digit && check_regex(j,RX_DATE,RE_Date)) {
+      TRACE(3,"Match DATE regex. "+form);
       token = TK_date;
     }
-    else if (RE_Time1.Search(form)) {
-      if(RE_Time1.Match(2)!=""){
+    else if (tc.digit && check_regex(j,RX_TIME1,RE_Time1)) {
+      if(check_regex(j,RX_HHMM,RE_Time1,true,2)){
 	TRACE(3,"Match TIME1 regex (hour+min)");
 	token = TK_hhmm;
       }
@@ -2709,7 +2702,7 @@ int dates_en::ComputeToken(int state, sentence::iterator &j, sentence &se)
 	token = TK_hour;
       }	 
     }
-    else if (RE_Time2.Search(form)) 
+    else if (tc.digit && check_regex(j,RX_TIME2,RE_Time2)) 
       token = TK_min;
 
     break;
@@ -2789,8 +2782,8 @@ int dates_en::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=0 && value<=60) {
       token = TK_minnum;
     }
-    else if (RE_Time1.Search(form)) {
-      if(RE_Time1.Match(2)!=""){
+    else if (tc.digit && check_regex(j,RX_TIME1,RE_Time1)) {
+      if(check_regex(j,RX_HHMM,RE_Time1,true,2)){
 	TRACE(3,"Match TIME1 regex (hour+min)");
 	token = TK_hhmm;
       }
@@ -2807,7 +2800,7 @@ int dates_en::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=0 && value<=60) {
       token=TK_minnum;
     }
-    else if (RE_Time2.Search(form)) {
+    else if (tc.digit && check_regex(j,RX_TIME2,RE_Time2)) {
       TRACE(3,"Match TIME2 regex (minutes)");
       token = TK_min;
     }    
@@ -2821,8 +2814,8 @@ int dates_en::ComputeToken(int state, sentence::iterator &j, sentence &se)
     if (token==TK_number && value>=0 && value<=24) {
       token = TK_hournum;
     }
-    else if (RE_Time1.Search(form)) {
-      if(RE_Time1.Match(2)!=""){
+    else if (tc.digit && check_regex(j,RX_TIME1,RE_Time1)) {
+      if(check_regex(j,RX_HHMM,RE_Time1,true,2)){
         TRACE(3,"Match TIME1 regex (hour+min)");
         token = TK_hhmm;
       }
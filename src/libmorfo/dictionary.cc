@@ -53,6 +53,10 @@ dictionary::dictionary(const std::string &Lang, const std::string &dicFile, bool
 
   // Opening a 4.0 or higher BerkeleyDB database, somewhat slower, but saves RAM.
   morfodb.open_database(dicFile);
+  // affix analysis searches many roots that are not in the dictionary,
+  // build a filter to discard them without accessing the database.
+  // This reads the whole dictionary once at each load.
+  if (AffixAnalysis) morfodb.build_filter();
   
   TRACE(3,"analyzer succesfully created");
 }
@@ -107,6 +111,15 @@ void dictionary::search_form(const std::string &s, std::list<analysis> &la) {
 
 }
 
+/////////////////////////////////////////////////////////////////////////////
+///  Check whether the form may be in the dictionary. False means
+///  it is surely not there, and search_form would find nothing.
+/////////////////////////////////////////////////////////////////////////////
+
+bool dictionary::may_contain_form(const std::string &s) const {
+  return morfodb.may_contain(util::lowercase(s));
+}
+
 /////////////////////////////////////////////////////////////////////////////
 ///  Search form in the dictionary, according to given options,
 ///  *Add* found analysis to the given word.
@@ -31,7 +31,9 @@
 
 #include "ukb/common.h"
 #include "ukb/kbGraph.h"
+#include "ukb/kbImage.h"
 #include "ukb/csentence.h"
+#include "ukb/wdict.h"
 #include "ukb/globalVars.h"
 
 #include "fries/util.h"
@@ -43,79 +45,154 @@ using namespace ukb;
 #define MOD_TRACENAME "WSD"
 #define MOD_TRACECODE SENSES_TRACE
 
-//constructor
-disambiguator::disambiguator(const string & relFile, const string & dictFile, double eps, int iter) {
+//workspace
+disambiguator::workspace::workspace() : ws(new Kb_workspace()), history(new deque<CSentence>()), context(new Kb_context_pv()) {}
+
+disambiguator::workspace::~workspace() { delete context; delete history; delete ws; }
 
-  // load graph
-  Kb::create_from_binfile(relFile);
+void disambiguator::workspace::clear_context() { history->clear(); context->count.clear(); }
+
+//constructor
+disambiguator::disambiguator(const string & relFile, const string & dictFile, double eps, int iter, int threads, double push, int warm, int stable, int win) {
 
   // set UKB stopping parameters
-  glVars::prank::threshold = eps;
-  glVars::prank::num_iterations = iter;
+  params = new Kb_prank_params();
+  params->threshold = eps;
+  params->num_iterations = iter;
+  // threads used by each PageRank iteration (needs OpenMP support)
+  params->num_threads = threads;
+#ifndef _OPENMP
+  if (threads>1) 
+    WARNING("FreeLing was built without OpenMP support. UKB will use a single thread instead of "+util::int2string(threads)+".");
+#endif
+  // if non-zero, approximate PPR by local push with this residual bound
+  params->push_threshold = push;
+  // initial ranks (0: uniform, 1: static PageRank, 2: previous call in the same workspace)
+  params->warm_start = warm;
+  // if non-zero, stop as soon as the order of target synsets is stable for this many iterations
+  params->stable_iterations = stable;
+  // sentences of context around each target sentence. 0 means the whole list.
+  window = (win<0 ? 0 : win);
+
+  kb = 0; dict = 0; img = 0;
+
+  if (KbImage::is_image(relFile)) {
+    // map compiled image, which already contains the dictionary
+    img = new KbImage(relFile);
+    params->use_weight = img->use_weight();
+    TRACE(2,"Mapped KB image "+relFile+". Dictionary "+dictFile+" not used.");
+    return;
+  }
+
+  // load graph and dictionary, owned by this instance
+  kb = new Kb(relFile);
+  dict = new WDict(dictFile);
 
   // adding the dictionary to the UKB graph
-  glVars::dict_filename = dictFile;  
-  Kb::instance().add_dictionary(false);
+  kb->add_dictionary(*dict, false);
+
+  // precompute everything pageRank needs, so kb is read-only from now on
+  if (glVars::csentence::disamb_minus_static || warm == Kb_prank_params::warm_static) 
+    kb->static_prank();
+  kb->init_pageRank(params->use_weight);
 }
 
 //destructor
-disambiguator::~disambiguator() {}
+disambiguator::~disambiguator() {
+  delete params;
+  delete img;
+  delete dict;
+  delete kb;
+}
 
 //retrieve numeric part of synset code
 string disambiguator::convert_synset(const string &syns) const {
   return syns.substr(0, 8);
 }
 
+//run UKB over given KB (graph or image), leaving synset ranks in cs
+template<class KB>
+static void rank_context(const KB & kb, CSentence & cs, const Kb_prank_params & params, Kb_workspace & kws) {
+
+  if (params.push_threshold > 0.0) {
+    // approximate PPR, exploring only the neighbourhood of context words
+    bool ok = calculate_kb_ppr_push(kb, cs, params, kws);
+    if (!ok) 
+      WARNING("No word links to KB when calculating ranks for sentence "+cs.id());
+    else
+      //ranks attributed to synsets for each word
+      disamb_csentence_kb(kb, cs, kws.sparse_ranks);
+  }
+  else {
+    bool ok = calculate_kb_ppr(kb, cs, params, kws);
+    if (!ok) 
+      WARNING("No word links to KB when calculating ranks for sentence "+cs.id());
+    else
+      //ranks attributed to synsets for each word
+      disamb_csentence_kb(kb, cs, kws.ranks);
+  }
+}
+
+//same, personalized by the words of a sliding window, leaving ranks of target words in cs
+template<class KB>
+static void rank_window(const KB & kb, const Kb_context_pv & pv, CSentence & cs, const Kb_prank_params & params, Kb_workspace & kws) {
+
+  if (params.push_threshold > 0.0) {
+    bool ok = calculate_kb_ppr_push(kb, pv, params, kws);
+    if (!ok) 
+      WARNING("No word links to KB when calculating ranks for sentence "+cs.id());
+    else
+      disamb_csentence_kb(kb, cs, kws.sparse_ranks);
+  }
+  else {
+    bool ok = calculate_kb_ppr(kb, pv, cs, params, kws);
+    if (!ok) 
+      WARNING("No word links to KB when calculating ranks for sentence "+cs.id());
+    else
+      disamb_csentence_kb(kb, cs, kws.ranks);
+  }
+}
+
 //comparison between pair<string, double> elements to sort a list of such elements in *decreasing* order
-bool comp_pair(pair<string,double> p1, pair<string,double> p2) { return (p1.second > p2.second); }
+static bool comp_pair(pair<string,double> p1, pair<string,double> p2) { return (p1.second > p2.second); }
 
 void disambiguator::analyze(std::list<sentence> & ls) const {
-  CSentence cs;
-	
-  //create one context from ls
-  list<sentence>::iterator is;
-  int id_numb = 0;
-  
-  list<sentence::iterator> lwctx;
-  
-  for (is=ls.begin(); is!=ls.end(); is++) {
+  // local workspace, so that concurrent calls do not share rank vectors
+  workspace ws;
+  analyze(ls, ws);
+}
+
+//context word for given lemma, looked up in the image or in graph+dictionary
+static CWord make_cword(const KbImage & img, const WDict * dict, const string & lemma, const string & id, char pos) {
+  return CWord(img, lemma, id, pos, CWord::cwdist);
+}
+
+static CWord make_cword(const Kb & kb, const WDict * dict, const string & lemma, const string & id, char pos) {
+  return CWord(kb, *dict, lemma, id, pos, CWord::cwdist);
+}
+
+//build UKB context for the content words of sentence s, remembering their positions
+template<class KB>
+static void build_context(const KB & kb, const WDict * dict, sentence & s, int & id_numb, 
+                   CSentence & cs, list<sentence::iterator> & lwctx) {
+  for (sentence::iterator w=s.begin(); w!=s.end(); w++) {
+    char pos = (util::lowercase(w->get_parole())).at(0);
+    if (pos=='j') pos='a';
     
-    sentence::iterator w;
-    for (w=is->begin(); w!=is->end(); w++) {
-      
-      char pos(0);
-      pos = (util::lowercase(w->get_parole())).at(0);
-      if (pos=='j') pos='a';
-      
-      if ((pos == 'a') || (pos == 'n') || (pos == 'r') || (pos == 'v')) {
-	const string & w_id = "" + id_numb;
-	CWord new_cw(w->get_lemma(), w_id, pos, CWord::cwdist);
-	cs.push_back(new_cw);
-	lwctx.push_back(w);
-      }
-      
-      id_numb++;
+    if ((pos == 'a') || (pos == 'n') || (pos == 'r') || (pos == 'v')) {
+      cs.push_back(make_cword(kb, dict, w->get_lemma(), util::int2string(id_numb), pos));
+      lwctx.push_back(w);
     }
+    id_numb++;
   }
-  
-  // no sentences (or no words) in given list.
-  if (id_numb==0) return;
-  
-  //calling ukb library to disambiguate
-  vector<float> ranks;
-  
-  bool ok = calculate_kb_ppr(cs,ranks);
-  if (!ok) 
-    WARNING("No word links to KB when calculating ranks for sentence "+cs.id());
-  
-  //ranks attributed to synsets for each word
-  disamb_csentence_kb(cs, ranks);
+}
 
-  //copying the synsets back into FreeLing analysis
+//copy synset ranks of words [first,last) in cs back into FreeLing analysis
+void disambiguator::set_senses(CSentence & cs, size_t first, size_t last, 
+                               list<sentence::iterator> & lwctx) const {
   list<sentence::iterator>::iterator ilwctx = lwctx.begin();
-  
-  vector<CWord>::iterator cw_it = cs.begin();
-  vector<CWord>::iterator cw_end = cs.end();
+  CSentence::iterator cw_it = cs.begin()+first;
+  CSentence::iterator cw_end = cs.begin()+last;
   size_t num_syns;
   
   for (; cw_it != cw_end; ++cw_it, ++ilwctx) {
@@ -139,6 +216,103 @@ void disambiguator::analyze(std::list<sentence> & ls) const {
   }
 }
 
+void disambiguator::analyze(std::list<sentence> & ls, workspace & w_ws) const {
+  if (window>0) {
+    analyze_window(ls, w_ws);
+    return;
+  }
+
+  CSentence cs;
+  //create one context from ls
+  int id_numb = 0;
+  list<sentence::iterator> lwctx;
+  for (list<sentence>::iterator is=ls.begin(); is!=ls.end(); is++) {
+    if (img) build_context(*img, dict, *is, id_numb, cs, lwctx);
+    else build_context(*kb, dict, *is, id_numb, cs, lwctx);
+  }
+  
+  // no sentences (or no words) in given list.
+  if (id_numb==0) return;
+  
+  //calling ukb library to disambiguate
+  if (img) rank_context(*img, cs, *params, *w_ws.ws);
+  else rank_context(*kb, cs, *params, *w_ws.ws);
+
+  //copying the synsets back into FreeLing analysis
+  set_senses(cs, 0, cs.size(), lwctx);
+}
+
+//disambiguate each sentence in ls using as context the 'window' sentences
+//before and after it. Only sentences with some content word are counted, 
+//both in ls and in the history. Sentences before the first in ls are taken 
+//from previous calls with the same workspace, so each sentence is annotated 
+//as soon as it is received, and the cost per sentence does not depend on how 
+//text is split into lists. The personalization vector is updated 
+//incrementally as the window slides (adding the sentence entering it and 
+//removing the one leaving it), and only the target sentence is ranked. With 
+//UKBWarmStart=previous PageRank starts from the solution of the previous window.
+void disambiguator::analyze_window(std::list<sentence> & ls, workspace & w_ws) const {
+  
+  deque<CSentence> & hist = *w_ws.history;
+  Kb_context_pv & pv = *w_ws.context;
+  int nh = hist.size();
+  
+  // words of each sentence are looked up only once, and reused by every window
+  vector<CSentence> vcs(ls.size());
+  vector<list<sentence::iterator> > vlw(ls.size());
+  int id_numb = 0;
+  int n = 0;
+  for (list<sentence>::iterator is=ls.begin(); is!=ls.end(); is++, n++) {
+    if (img) build_context(*img, dict, *is, id_numb, vcs[n], vlw[n]);
+    else build_context(*kb, dict, *is, id_numb, vcs[n], vlw[n]);
+  }
+
+  // sentences with content words, following those in the history. Those 
+  // without any have nothing to disambiguate, and are not counted in the window
+  vector<CSentence*> seq;
+  vector<int> cont;
+  for (deque<CSentence>::iterator h=hist.begin(); h!=hist.end(); h++) 
+    seq.push_back(&(*h));
+  for (int i=0; i<n; i++) 
+    if (vcs[i].size()>0) { 
+      cont.push_back(i); 
+      seq.push_back(&vcs[i]);
+    }
+  int nc = cont.size();
+
+  // pv holds the sentences [lo,hi) of seq. Between calls, it holds the history.
+  int lo=0, hi=nh;
+  for (int k=0; k<nc; k++) {
+    int t = nh+k;
+    for (; hi<nh+nc && hi<=t+window; hi++) {
+      if (img) cs_context_pv(*img, *seq[hi], 1, pv);
+      else cs_context_pv(*kb, *seq[hi], 1, pv);
+    }
+    for (; lo<t-window; lo++) {
+      if (img) cs_context_pv(*img, *seq[lo], -1, pv);
+      else cs_context_pv(*kb, *seq[lo], -1, pv);
+    }
+
+    TRACE(3,"Window for sentence "+util::int2string(cont[k])+" has "+util::int2string(hi-lo)+" sentences");
+
+    CSentence & cs = *seq[t];
+    if (img) rank_window(*img, pv, cs, *params, *w_ws.ws);
+    else rank_window(*kb, pv, cs, *params, *w_ws.ws);
+
+    set_senses(cs, 0, cs.size(), vlw[cont[k]]);
+  }
+
+  // keep last sentences as left context for next call
+  for (; lo<nh+nc-window; lo++) {
+    if (img) cs_context_pv(*img, *seq[lo], -1, pv);
+    else cs_context_pv(*kb, *seq[lo], -1, pv);
+  }
+  for (int k=0; k<nc; k++) {
+    hist.push_back(vcs[cont[k]]);
+    if ((int)hist.size() > window) hist.pop_front();
+  }
+}
+
 
 list<sentence> disambiguator::analyze(const list<sentence> & ls) const {
   list<sentence> s=ls;
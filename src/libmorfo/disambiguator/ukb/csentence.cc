@@ -2,6 +2,7 @@
 #include "common.h"
 #include "globalVars.h"
 #include "kbGraph.h"
+#include "kbImage.h"
 #include "wdict.h"
 
 // Tokenizer
@@ -34,15 +35,32 @@ namespace ukb {
 	return res;
   }
 
-  bool CWord::tie_to_kb() {
+  // Get the KB vertex of the i-th dictionary entry. Entries of a WDict
+  // are looked up by name in the Kb, entries of KB images already hold it.
 
-	Kb & kb = ukb::Kb::instance();
-	bool existP;
-	map<string, pair<Kb_vertex_t, float> > str2kb;
-	vector<string>::const_iterator str_it;
-	vector<string>::const_iterator str_end;
+  namespace {
+	struct kb_entry_vertex {
+	  kb_entry_vertex(const Kb & kb_) : kb(kb_) {}
+	  bool operator()(const WDict_entries & entries, size_t i, Kb_vertex_t & u) const {
+		bool existP;
+		tie(u, existP) = kb.get_vertex_by_name(entries.get_entry(i), Kb::is_concept);
+		return existP;
+	  }
+	  const Kb & kb;
+	};
+
+	struct image_entry_vertex {
+	  bool operator()(const KbImage_entries & entries, size_t i, Kb_vertex_t & u) const {
+		u = entries.get_vertex(i);
+		return true;
+	  }
+	};
+  }
+
+  template<typename Entries, typename EntryVertex>
+  bool CWord::tie_to_kb(const Entries & entries, const EntryVertex & entry_vertex, bool shuffle) {
 
-	WDict_entries entries = WDict::instance().get_entries(w);
+	map<string, pair<Kb_vertex_t, float> > str2kb;
 
 	for(size_t i= 0; i < entries.size(); ++i) {
 
@@ -59,8 +77,7 @@ namespace ukb {
 	  }
 
 	  Kb_vertex_t syn_v;
-	  tie(syn_v, existP) = kb.get_vertex_by_name(syn_str, Kb::is_concept);
-	  if (existP) {
+	  if (entry_vertex(entries, i, syn_v)) {
 		m_syns.push_back(syn_str);
 		str2kb[syn_str] = make_pair(syn_v, syn_freq);
 	  } else {
@@ -73,8 +90,10 @@ namespace ukb {
 	if (m_syns.size() == 0) return false;
 
 	// Shuffle synsets string vector
-	boost::random_number_generator<boost::mt19937, long int> rand_dist(glVars::rand_generator);
-	std::random_shuffle(m_syns.begin(), m_syns.end(), rand_dist);
+	if (shuffle) {
+	  boost::random_number_generator<boost::mt19937, long int> rand_dist(glVars::rand_generator);
+	  std::random_shuffle(m_syns.begin(), m_syns.end(), rand_dist);
+	}
 
 	// Update ranks
 	vector<float>(m_syns.size(), 0.0).swap(m_ranks);
@@ -107,14 +126,14 @@ namespace ukb {
 	return true;
   }
 
-  CWord::CWord(const string & w_, const string & id_, char pos_, cwtype type_, float wght_)
-	: w(w_), m_id(id_), m_pos(pos_), m_weight(wght_), m_type(type_) {
+  template<typename KB, typename D, typename EntryVertex>
+  void CWord::init_cword(const KB & kb, const D & dict, const EntryVertex & entry_vertex, bool shuffle) {
 	switch(m_type) {
 	case cwsynset:
 
 	  Kb_vertex_t u;
 	  bool P;
-	  tie(u, P) = ukb::Kb::instance().get_vertex_by_name(w, Kb::is_concept);
+	  tie(u, P) = kb.get_vertex_by_name(w, Kb::is_concept);
 	  if (!P) {
 		throw std::runtime_error("CWord concept " + w + " not in KB");
 	  }
@@ -125,7 +144,7 @@ namespace ukb {
 	  break;
 	case cwtoken:
 	case cwdist:
-	  tie_to_kb();
+	  tie_to_kb(dict.get_entries(w), entry_vertex, shuffle);
 	  m_disamb = (1 == m_syns.size()); // monosemous words are disambiguated
 	  break;
 	default:
@@ -133,6 +152,23 @@ namespace ukb {
 	}
   }
 
+  CWord::CWord(const string & w_, const string & id_, char pos_, cwtype type_, float wght_)
+	: w(w_), m_id(id_), m_pos(pos_), m_weight(wght_), m_type(type_) {
+	init_cword(ukb::Kb::instance(), WDict::instance(), kb_entry_vertex(ukb::Kb::instance()), true);
+  }
+
+  CWord::CWord(const Kb & kb, const WDict & dict,
+			   const string & w_, const string & id_, char pos_, cwtype type_, float wght_)
+	: w(w_), m_id(id_), m_pos(pos_), m_weight(wght_), m_type(type_) {
+	init_cword(kb, dict, kb_entry_vertex(kb), false);
+  }
+
+  CWord::CWord(const KbImage & img,
+			   const string & w_, const string & id_, char pos_, cwtype type_, float wght_)
+	: w(w_), m_id(id_), m_pos(pos_), m_weight(wght_), m_type(type_) {
+	init_cword(img, img, image_entry_vertex(), false);
+  }
+
   CWord & CWord::operator=(const CWord & cw_) {
 	if (&cw_ != this) {
 	  w = cw_.w;
@@ -529,18 +565,18 @@ namespace ukb {
   // PageRank in Kb
 
 
-  // Get personalization vector giving an csentence
-  // 'light' wpos
+  // Get sparse personalization vector giving an csentence
+  // 'light' wpos. Each element is a vertex and its (normalized) weight
 
-  int cs_pv_vector_w(const CSentence & cs,
-					 vector<float> & pv,
+  template<typename KB>
+  int cs_pv_sparse_w(const KB & kb,
+					 const CSentence & cs,
+					 vector<pair<Kb_vertex_t, float> > & pv,
 					 CSentence::const_iterator exclude_word_it) {
 
-	Kb & kb = ukb::Kb::instance();
-	vector<float> (kb.size(), 0.0).swap(pv);
+	pv.clear();
 	bool aux;
 	set<string> S;
-	vector<float> ranks;
 	int inserted_i = 0;
 
 	float K = 0.0;
@@ -558,7 +594,7 @@ namespace ukb {
 		tie(u, aux) = kb.get_vertex_by_name(wpos, sflags);
 		float w = glVars::csentence::pv_no_weight ? 1.0 : it->get_weight();
 		if (aux && w != 0.0) {
-		  pv[u] += w;
+		  pv.push_back(make_pair(u, w));
 		  K +=w;
 		  inserted_i++;
 		}
@@ -567,8 +603,23 @@ namespace ukb {
 	if (!inserted_i) return 0;
 	// Normalize PPV vector
 	float div = 1.0 / static_cast<float>(K);
-	for(vector<float>::iterator it = pv.begin(), end = pv.end();
-		it != end; ++it) *it *= div;
+	for(vector<pair<Kb_vertex_t, float> >::iterator it = pv.begin(), end = pv.end();
+		it != end; ++it) it->second *= div;
+	return inserted_i;
+  }
+
+  // Get personalization vector giving an csentence
+  // 'light' wpos
+
+  int cs_pv_vector_w(const CSentence & cs,
+					 vector<float> & pv,
+					 CSentence::const_iterator exclude_word_it) {
+
+	vector<pair<Kb_vertex_t, float> > spv;
+	int inserted_i = cs_pv_sparse_w(ukb::Kb::instance(), cs, spv, exclude_word_it);
+	vector<float> (ukb::Kb::instance().size(), 0.0).swap(pv);
+	for(vector<pair<Kb_vertex_t, float> >::iterator it = spv.begin(), end = spv.end();
+		it != end; ++it) pv[it->first] += it->second;
 	return inserted_i;
   }
 
@@ -590,19 +641,280 @@ namespace ukb {
 	return true;
   }
 
+  // Same as above, but approximating the PPV by local push from the
+  // words of the context, with glVars::prank::push_threshold as
+  // residual bound. Only the explored neighbourhood is stored in res.
+
+  bool calculate_kb_ppr_push(const CSentence & cs,
+							 Kb_sparse_ranks & res) {
+
+	Kb & kb = ukb::Kb::instance();
+	vector<pair<Kb_vertex_t, float> > pv;
+	int aux = cs_pv_sparse_w(kb, cs, pv, cs.end());
+	if (!aux) return false;
+	// Execute local push PageRank
+	kb.pageRank_push(pv, glVars::prank::push_threshold, res);
+	return true;
+  }
+
+  // Put the synsets of each ambiguous target word of cs as a group of
+  // watched vertices in ws, so that pageRank may stop as soon as their
+  // order is stable.
+
+  void cs_watch_synsets(const CSentence & cs, Kb_workspace & ws) {
+
+	ws.watch_offsets.assign(1, 0);
+	ws.watch_V.clear();
+	for(CSentence::const_iterator it = cs.begin(), end = cs.end();
+		it != end; ++it) {
+	  if (!it->is_distinguished() || it->size() < 2) continue;
+	  for(size_t i = 0; i != it->size(); ++i)
+		ws.watch_V.push_back(it->syn_vertex(i));
+	  ws.watch_offsets.push_back(ws.watch_V.size());
+	}
+  }
+
+  // Reentrant versions of the above. Only the entries of ws.ppv set by
+  // the previous call are cleared, so the dense vector is not
+  // reinitialized for every context.
+
+  static void clear_ppv_ws(size_t N, Kb_workspace & ws) {
+
+	if (ws.ppv.size() != N) {
+	  vector<float>(N, 0.0).swap(ws.ppv);
+	} else {
+	  for(vector<pair<Kb_vertex_t, float> >::iterator it = ws.seeds.begin(), end = ws.seeds.end();
+		  it != end; ++it) ws.ppv[it->first] = 0.0;
+	}
+  }
+
+  static void set_ppv_ws(Kb_workspace & ws) {
+
+	for(vector<pair<Kb_vertex_t, float> >::iterator it = ws.seeds.begin(), end = ws.seeds.end();
+		it != end; ++it) ws.ppv[it->first] += it->second;
+  }
+
+  template<typename KB>
+  bool calculate_kb_ppr_ws(const KB & kb,
+						   const CSentence & cs,
+						   const Kb_prank_params & params,
+						   Kb_workspace & ws) {
+
+	clear_ppv_ws(kb.size(), ws);
+	int aux = cs_pv_sparse_w(kb, cs, ws.seeds, cs.end());
+	if (!aux) return false;
+	set_ppv_ws(ws);
+	if (params.stable_iterations) cs_watch_synsets(cs, ws);
+	// Execute PageRank
+	kb.pageRank_ppv(params, ws);
+	return true;
+  }
+
+  template<typename KB>
+  bool calculate_kb_ppr_push_ws(const KB & kb,
+								const CSentence & cs,
+								const Kb_prank_params & params,
+								Kb_workspace & ws) {
+
+	int aux = cs_pv_sparse_w(kb, cs, ws.seeds, cs.end());
+	if (!aux) return false;
+	// Execute local push PageRank
+	kb.pageRank_push(params, ws);
+	return true;
+  }
+
+
+  bool calculate_kb_ppr(const Kb & kb,
+						const CSentence & cs,
+						const Kb_prank_params & params,
+						Kb_workspace & ws) {
+	return calculate_kb_ppr_ws(kb, cs, params, ws);
+  }
+
+  bool calculate_kb_ppr(const KbImage & img,
+						const CSentence & cs,
+						const Kb_prank_params & params,
+						Kb_workspace & ws) {
+	return calculate_kb_ppr_ws(img, cs, params, ws);
+  }
+
+  bool calculate_kb_ppr_push(const Kb & kb,
+							 const CSentence & cs,
+							 const Kb_prank_params & params,
+							 Kb_workspace & ws) {
+	return calculate_kb_ppr_push_ws(kb, cs, params, ws);
+  }
+
+  bool calculate_kb_ppr_push(const KbImage & img,
+							 const CSentence & cs,
+							 const Kb_prank_params & params,
+							 Kb_workspace & ws) {
+	return calculate_kb_ppr_push_ws(img, cs, params, ws);
+  }
+
+  // Sliding contexts. A vertex stays in the personalization while some
+  // word of the context is linked to it, with the mean weight of those
+  // words, as repeated words are only counted once by cs_pv_sparse_w.
+
+  template<typename KB>
+  void cs_context_pv_kb(const KB & kb, const CSentence & cs, int delta,
+						Kb_context_pv & pv) {
+
+	for(CSentence::const_iterator it = cs.begin(), end = cs.end();
+		it != end; ++it) {
+	  unsigned char sflags = it->is_synset() ? Kb::is_concept : Kb::is_word;
+	  Kb_vertex_t u;
+	  bool aux;
+	  tie(u, aux) = kb.get_vertex_by_name(it->wpos(), sflags);
+	  float w = glVars::csentence::pv_no_weight ? 1.0 : it->get_weight();
+	  if (!aux || w == 0.0) continue;
+	  map<Kb_vertex_t, pair<int, float> >::iterator c = pv.count.find(u);
+	  if (c == pv.count.end()) {
+		if (delta > 0) pv.count.insert(make_pair(u, make_pair(delta, delta * w)));
+		continue;
+	  }
+	  c->second.first += delta;
+	  c->second.second += delta * w;
+	  if (c->second.first <= 0) pv.count.erase(c);
+	}
+  }
+
+  void cs_context_pv(const Kb & kb, const CSentence & cs, int delta,
+					 Kb_context_pv & pv) {
+	cs_context_pv_kb(kb, cs, delta, pv);
+  }
+
+  void cs_context_pv(const KbImage & img, const CSentence & cs, int delta,
+					 Kb_context_pv & pv) {
+	cs_context_pv_kb(img, cs, delta, pv);
+  }
+
+  // Get normalized sparse personalization vector of a sliding context
+
+  static int context_pv_sparse(const Kb_context_pv & pv,
+							   vector<pair<Kb_vertex_t, float> > & spv) {
+
+	spv.clear();
+	float K = 0.0;
+	for(map<Kb_vertex_t, pair<int, float> >::const_iterator it = pv.count.begin(), end = pv.count.end();
+		it != end; ++it) {
+	  float w = it->second.second / static_cast<float>(it->second.first);
+	  spv.push_back(make_pair(it->first, w));
+	  K += w;
+	}
+	if (spv.empty()) return 0;
+	float div = 1.0 / K;
+	for(vector<pair<Kb_vertex_t, float> >::iterator it = spv.begin(), end = spv.end();
+		it != end; ++it) it->second *= div;
+	return spv.size();
+  }
+
+  template<typename KB>
+  bool calculate_kb_ppr_context_ws(const KB & kb,
+								   const Kb_context_pv & pv,
+								   const CSentence & target,
+								   const Kb_prank_params & params,
+								   Kb_workspace & ws) {
+
+	clear_ppv_ws(kb.size(), ws);
+	int aux = context_pv_sparse(pv, ws.seeds);
+	if (!aux) return false;
+	set_ppv_ws(ws);
+	if (params.stable_iterations) cs_watch_synsets(target, ws);
+	// Execute PageRank
+	kb.pageRank_ppv(params, ws);
+	return true;
+  }
+
+  template<typename KB>
+  bool calculate_kb_ppr_push_context_ws(const KB & kb,
+										const Kb_context_pv & pv,
+										const Kb_prank_params & params,
+										Kb_workspace & ws) {
+
+	int aux = context_pv_sparse(pv, ws.seeds);
+	if (!aux) return false;
+	// Execute local push PageRank
+	kb.pageRank_push(params, ws);
+	return true;
+  }
+
+  bool calculate_kb_ppr(const Kb & kb,
+						const Kb_context_pv & pv,
+						const CSentence & target,
+						const Kb_prank_params & params,
+						Kb_workspace & ws) {
+	return calculate_kb_ppr_context_ws(kb, pv, target, params, ws);
+  }
+
+  bool calculate_kb_ppr_push(const Kb & kb,
+							 const Kb_context_pv & pv,
+							 const Kb_prank_params & params,
+							 Kb_workspace & ws) {
+	return calculate_kb_ppr_push_context_ws(kb, pv, params, ws);
+  }
+
+  bool calculate_kb_ppr(const KbImage & img,
+						const Kb_context_pv & pv,
+						const CSentence & target,
+						const Kb_prank_params & params,
+						Kb_workspace & ws) {
+	return calculate_kb_ppr_context_ws(img, pv, target, params, ws);
+  }
+
+  bool calculate_kb_ppr_push(const KbImage & img,
+							 const Kb_context_pv & pv,
+							 const Kb_prank_params & params,
+							 Kb_workspace & ws) {
+	return calculate_kb_ppr_push_context_ws(img, pv, params, ws);
+  }
+
 
   // Given 2 vectors (va, vb) return the vector going from va to vb
   // res[i] = vb[i] - va[1]
 
+  template<typename Map, typename MapB = vector<float> >
   struct va2vb {
-	va2vb(const vector<float> & va, const vector<float> & vb) :
+	va2vb(const Map & va, const MapB & vb) :
 	  m_va(va), m_vb(vb) {}
 	float operator[](size_t i) const {
 	  return m_vb[i] - m_va[i];
 	}
   private:
-	const vector<float> & m_va;
-	const vector<float> & m_vb;
+	const Map & m_va;
+	const MapB & m_vb;
+  };
+
+  // Static ranks of kb, as a map
+
+  inline const vector<float> & static_ranks(const Kb & kb) {
+	return kb.static_prank();
+  }
+
+  inline const float * static_ranks(const KbImage & img) {
+	return img.static_prank();
+  }
+
+  // Rank synsets of cw with the difference between ranks and the
+  // static ranks
+
+  template<typename Map, typename MapB>
+  void rank_synsets_minus(CWord & cw, const Map & ranks, const MapB & static_ranks) {
+	va2vb<Map, MapB> newrank(ranks, static_ranks);
+	cw.rank_synsets(newrank);
+  }
+
+  // Read-only view of a sparse rank map. Vertices not in the map have
+  // rank zero.
+
+  struct sparse_ranks_view {
+	sparse_ranks_view(const Kb_sparse_ranks & r) : m_r(r) {}
+	float operator[](Kb_vertex_t u) const {
+	  Kb_sparse_ranks::const_iterator it = m_r.find(u);
+	  return it == m_r.end() ? 0.0f : it->second;
+	}
+  private:
+	const Kb_sparse_ranks & m_r;
   };
 
   // given a word,
@@ -629,7 +941,7 @@ namespace ukb {
 		kb.pageRank_ppv(pv, ranks);
 		// disambiguate cw_it
 		if (glVars::csentence::disamb_minus_static) {
-		  struct va2vb newrank(ranks, kb.static_prank());
+		  va2vb<vector<float> > newrank(ranks, kb.static_prank());
 		  cw_it->rank_synsets(newrank);
 		} else {
 		  cw_it->rank_synsets(ranks);
@@ -687,18 +999,17 @@ namespace ukb {
   // Disambiguate a CSentence given a vector of ranks
   //
 
-  void disamb_csentence_kb(CSentence & cs,
-							const vector<float> & ranks) {
-
-	Kb & kb = ukb::Kb::instance();
+  template<typename KB, typename Map>
+  void disamb_csentence_kb_map(const KB & kb,
+							   CSentence & cs,
+							   const Map & ranks) {
 
 	vector<CWord>::iterator cw_it = cs.begin();
 	vector<CWord>::iterator cw_end = cs.end();
 	for(; cw_it != cw_end; ++cw_it) {
 	  if (!cw_it->is_distinguished()) continue;
 	  if (glVars::csentence::disamb_minus_static) {
-		struct va2vb newrank(ranks, kb.static_prank());
-		cw_it->rank_synsets(newrank);
+		rank_synsets_minus(*cw_it, ranks, static_ranks(kb));
 	  } else {
 		cw_it->rank_synsets(ranks);
 	  }
@@ -706,6 +1017,40 @@ namespace ukb {
 	}
   }
 
+  void disamb_csentence_kb(CSentence & cs,
+							const vector<float> & ranks) {
+	disamb_csentence_kb_map(ukb::Kb::instance(), cs, ranks);
+  }
+
+  void disamb_csentence_kb(CSentence & cs,
+							const Kb_sparse_ranks & ranks) {
+	disamb_csentence_kb_map(ukb::Kb::instance(), cs, sparse_ranks_view(ranks));
+  }
+
+  void disamb_csentence_kb(const Kb & kb,
+						   CSentence & cs,
+						   const vector<float> & ranks) {
+	disamb_csentence_kb_map(kb, cs, ranks);
+  }
+
+  void disamb_csentence_kb(const Kb & kb,
+						   CSentence & cs,
+						   const Kb_sparse_ranks & ranks) {
+	disamb_csentence_kb_map(kb, cs, sparse_ranks_view(ranks));
+  }
+
+  void disamb_csentence_kb(const KbImage & img,
+						   CSentence & cs,
+						   const vector<float> & ranks) {
+	disamb_csentence_kb_map(img, cs, ranks);
+  }
+
+  void disamb_csentence_kb(const KbImage & img,
+						   CSentence & cs,
+						   const Kb_sparse_ranks & ranks) {
+	disamb_csentence_kb_map(img, cs, sparse_ranks_view(ranks));
+  }
+
 
   ////////////////////////////////////////////////////////
   // Streaming
@@ -6,12 +6,14 @@
 #include "kbGraph.h"
 #include <string>
 #include <vector>
+#include <map>
 #include <iosfwd>
 #include <boost/graph/graph_traits.hpp>
 
 namespace ukb {
 
   class CSentence; // forward declaration
+  class KbImage;
 
   class CWord {
 
@@ -33,6 +35,13 @@ namespace ukb {
 
 	explicit CWord() : m_pos(0), m_weight(1.0), m_type(cwerror), m_disamb(false) {};
 	CWord(const std::string & w_, const std::string & id, char pos, cwtype type, float wght_ = 1.0);
+	// Same, but looking words up in the given kb and dictionary. Synsets
+	// are not shuffled, so several threads may build CWords at once.
+	CWord(const Kb & kb, const WDict & dict,
+		  const std::string & w_, const std::string & id, char pos, cwtype type, float wght_ = 1.0);
+	// Same, looking words up in a KB image
+	CWord(const KbImage & img,
+		  const std::string & w_, const std::string & id, char pos, cwtype type, float wght_ = 1.0);
 	CWord & operator=(const CWord & cw_);
 	~CWord() {};
 
@@ -43,6 +52,7 @@ namespace ukb {
 	size_type size() const {return m_syns.size(); }
 
 	const std::string & syn(size_t i) const { return m_syns[i];}
+	Kb_vertex_t syn_vertex(size_t i) const { return m_V[i];}
 	float rank(size_t i) const { return m_ranks[i];}
 
 	std::string word() const { return w; }
@@ -69,7 +79,7 @@ namespace ukb {
 
 
 	template <typename Map>
-	void rank_synsets(Map rankMap) {
+	void rank_synsets(const Map & rankMap) {
 	  size_t n = m_syns.size();
 	  size_t i;
 	  if (!n) return; // No synsets
@@ -79,7 +89,7 @@ namespace ukb {
 
 	// Used in disambGraph
 	template <typename G, typename Map>
-	void rank_synsets(G & g, Map rankMap) {
+	void rank_synsets(G & g, const Map & rankMap) {
 	  size_t n = m_syns.size();
 	  size_t i;
 	  if (!n) return; // No synsets
@@ -101,7 +111,10 @@ namespace ukb {
 
   private:
 
-	bool tie_to_kb();
+	template<typename KB, typename D, typename EntryVertex>
+	void init_cword(const KB & kb, const D & dict, const EntryVertex & entry_vertex, bool shuffle);
+	template<typename Entries, typename EntryVertex>
+	bool tie_to_kb(const Entries & entries, const EntryVertex & entry_vertex, bool shuffle);
 	void read_from_stream (std::ifstream & is);
 	std::ofstream & write_to_stream(std::ofstream & o) const;
 	void shuffle_synsets();
@@ -170,11 +183,103 @@ namespace ukb {
   bool calculate_kb_ppr(const CSentence & cs,
 						std::vector<float> & res);
 
+  bool calculate_kb_ppr_push(const CSentence & cs,
+							 Kb_sparse_ranks & res);
+
   void calculate_kb_ppr_by_word_and_disamb(CSentence & cs);
 
   bool calculate_kb_ppv_csentence(CSentence & cs, std::vector<float> & res);
 
   void disamb_csentence_kb(CSentence & cs,
 							const std::vector<float> & ranks);
+
+  void disamb_csentence_kb(CSentence & cs,
+							const Kb_sparse_ranks & ranks);
+
+  // Reentrant versions. They only read the given kb, and keep all
+  // intermediate vectors in the workspace ws, so that they are reused
+  // across calls. The result is left in ws.ranks (ws.sparse_ranks for
+  // the push version). kb.init_pageRank(params.use_weight) must have
+  // been called before.
+
+  bool calculate_kb_ppr(const Kb & kb,
+						const CSentence & cs,
+						const Kb_prank_params & params,
+						Kb_workspace & ws);
+
+  bool calculate_kb_ppr_push(const Kb & kb,
+							 const CSentence & cs,
+							 const Kb_prank_params & params,
+							 Kb_workspace & ws);
+
+  void disamb_csentence_kb(const Kb & kb,
+						   CSentence & cs,
+						   const std::vector<float> & ranks);
+
+  void disamb_csentence_kb(const Kb & kb,
+						   CSentence & cs,
+						   const Kb_sparse_ranks & ranks);
+
+  // Same, over a KB image
+
+  bool calculate_kb_ppr(const KbImage & img,
+						const CSentence & cs,
+						const Kb_prank_params & params,
+						Kb_workspace & ws);
+
+  bool calculate_kb_ppr_push(const KbImage & img,
+							 const CSentence & cs,
+							 const Kb_prank_params & params,
+							 Kb_workspace & ws);
+
+  void disamb_csentence_kb(const KbImage & img,
+						   CSentence & cs,
+						   const std::vector<float> & ranks);
+
+  void disamb_csentence_kb(const KbImage & img,
+						   CSentence & cs,
+						   const Kb_sparse_ranks & ranks);
+
+  // Personalization of a sliding context of sentences. For each
+  // vertex, the number of context words linked to it and the sum of
+  // their weights, so that sentences may enter and leave the context
+  // without looking at the rest of it.
+
+  struct Kb_context_pv {
+	std::map<Kb_vertex_t, std::pair<int, float> > count;
+  };
+
+  // Add (delta = 1) or remove (delta = -1) the words of cs to pv
+
+  void cs_context_pv(const Kb & kb, const CSentence & cs, int delta,
+					 Kb_context_pv & pv);
+
+  void cs_context_pv(const KbImage & img, const CSentence & cs, int delta,
+					 Kb_context_pv & pv);
+
+  // Reentrant PageRank personalized by a sliding context. Only the
+  // words of target are watched (see Kb_prank_params::stable_iterations)
+
+  bool calculate_kb_ppr(const Kb & kb,
+						const Kb_context_pv & pv,
+						const CSentence & target,
+						const Kb_prank_params & params,
+						Kb_workspace & ws);
+
+  bool calculate_kb_ppr_push(const Kb & kb,
+							 const Kb_context_pv & pv,
+							 const Kb_prank_params & params,
+							 Kb_workspace & ws);
+
+  bool calculate_kb_ppr(const KbImage & img,
+						const Kb_context_pv & pv,
+						const CSentence & target,
+						const Kb_prank_params & params,
+						Kb_workspace & ws);
+
+  bool calculate_kb_ppr_push(const KbImage & img,
+							 const Kb_context_pv & pv,
+							 const Kb_prank_params & params,
+							 Kb_workspace & ws);
 }
 #endif
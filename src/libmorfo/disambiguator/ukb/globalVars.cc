@@ -47,6 +47,10 @@ namespace ukb {
 	  size_t num_iterations = 30; // Conservative, but stop if threshold is reached. If zero, just use threshold.
 	  float threshold = 0.0001; // If zero just use num_iterations
 	  float damping = 0.85; // damping factor
+	  int num_threads = 1; // Only used if compiled with OpenMP support
+	  float push_threshold = 0.0; // Residual bound for local push. If zero use power method
+	  int warm_start = 0; // Start from uniform ranks
+	  int stable_iterations = 0; // Only use threshold and num_iterations
 	}
 
 	namespace input {
@@ -47,6 +47,11 @@ namespace ukb {
 	  extern size_t num_iterations;
 	  extern float threshold;
 	  extern float damping;
+	  extern int num_threads;   // Threads used in each pagerank iteration
+	  extern float push_threshold; // If non zero, approximate PPR by local push
+	  extern int warm_start;    // Initial ranks: 0 uniform, 1 static pagerank, 2 previous result
+	  extern int stable_iterations; // If non zero, stop when the order of the watched
+	                                // vertices does not change for this many iterations
 	}
 
 
@@ -52,6 +52,42 @@ namespace ukb {
   // Class Kb
 
 
+  ////////////////////////////////////////////////////////////////////////////////
+  // pageRank parameters
+
+  Kb_prank_params::Kb_prank_params() :
+	use_weight(glVars::prank::use_weight),
+	num_iterations(glVars::prank::num_iterations),
+	threshold(glVars::prank::threshold),
+	damping(glVars::prank::damping),
+	num_threads(glVars::prank::num_threads),
+	push_threshold(glVars::prank::push_threshold),
+	warm_start(glVars::prank::warm_start),
+	stable_iterations(glVars::prank::stable_iterations) {}
+
+  bool Kb_init_ranks(size_t N, const Kb_prank_params & params,
+					 const float * static_ranks,
+					 vector<float> & ranks,
+					 vector<float> & rank_tmp) {
+
+	bool warm = false;
+	if (params.warm_start == Kb_prank_params::warm_previous && ranks.size() == N) {
+	  warm = true;
+	} else if (ranks.size() != N) {
+	  vector<float>(N, 0.0).swap(ranks); // Initialize rank vector
+	}
+	if (params.warm_start == Kb_prank_params::warm_static && static_ranks) {
+	  std::copy(static_ranks, static_ranks + N, ranks.begin());
+	  warm = true;
+	}
+	if (N == rank_tmp.size()) {
+	  std::fill(rank_tmp.begin(), rank_tmp.end(), 0.0);
+	} else {
+	  vector<float>(N, 0.0).swap(rank_tmp); // auxiliary rank vector
+	}
+	return warm;
+  }
+
   ////////////////////////////////////////////////////////////////////////////////
   // Singleton stuff
 
@@ -93,6 +129,15 @@ namespace ukb {
 	p_instance = tenp;
   }
 
+  Kb::Kb(const std::string & fname) : N_no_isolated(0), coef_status(0) {
+
+	ifstream fi(fname.c_str(), ifstream::binary|ifstream::in);
+	if (!fi) {
+	  throw runtime_error("Kb: can't open " + fname);
+	}
+	read_from_stream(fi);
+  }
+
   ////////////////////////////////////////////////////////////////////////////////
 
 
@@ -355,6 +400,7 @@ namespace ukb {
   }
 
   void Kb::unlink_vertex(Kb_vertex_t u) {
+	coef_status = 0; // reset out degree coefficients
 	clear_vertex(u, g);
   }
 
@@ -365,6 +411,7 @@ namespace ukb {
 	tie(it, end) = vertices(g);
 	for(; it != end; ++it) {
 	  if(out_degree(*it, g) == 0 && in_degree(*it, g) != 0) {
+		coef_status = 0; // reset out degree coefficients
 		clear_vertex(*it, g);
 		++n;
 	  }
@@ -503,13 +550,18 @@ namespace ukb {
 	// Hack to remove const-ness
     Kb & me = const_cast<Kb &>(*this);
 	vector<float> & ranks = me.static_ranks;
-	me.out_coefs.resize(N);
 
-	size_t N_no_isolated = prank::init_out_coefs(g, &me.out_coefs[0]);
+	// static pageRank ignores edge weights
+	me.init_pageRank(false);
 
 	if (N_no_isolated == 0) return static_ranks; // empty graph
 	vector<float> ppv(N, 1.0/static_cast<float>(N_no_isolated));
-	me.pageRank_ppv(ppv, ranks);
+	vector<float> rank_tmp;
+	Kb_prank_params params;
+	params.use_weight = false;
+	params.warm_start = Kb_prank_params::warm_none;
+	params.stable_iterations = 0;
+	run_pageRank(ppv, ranks, rank_tmp, params);
 	return static_ranks;
   }
 
@@ -793,14 +845,15 @@ namespace ukb {
 
   typedef pair<Kb_vertex_t, float> Syn_elem;
 
-  void create_w2wpos_maps(const string & word,
+  void create_w2wpos_maps(const Kb & kb,
+						  const WDict & dict,
+						  const string & word,
 						  vector<string> & wPosV,
 						  map<string, vector<Syn_elem> > & wPos2Syns) {
 
 	bool auxP;
-	const Kb & kb = Kb::instance();
 
-	WDict_entries syns = WDict::instance().get_entries(word);
+	WDict_entries syns = dict.get_entries(word);
 
 	for(size_t i = 0; i < syns.size(); ++i) {
 
@@ -831,13 +884,12 @@ namespace ukb {
 	}
   }
 
-  void insert_wpos(const string & word,
+  void insert_wpos(Kb & kb,
+				   const string & word,
 				   vector<string> & wPosV,
 				   map<string, vector<Syn_elem> > & wPos2Syns,
 				   bool use_weights) {
 
-	Kb & kb = Kb::instance();
-
 	// insert word
 	Kb_vertex_t word_v = kb.find_or_insert_word(word);
 
@@ -861,11 +913,9 @@ namespace ukb {
 	}
   }
 
-  void insert_word(const string & word, bool use_w) {
+  void insert_word(Kb & kb, const WDict & dict, const string & word, bool use_w) {
 
-	Kb & kb = Kb::instance();
-
-	WDict_entries syns = WDict::instance().get_entries(word);
+	WDict_entries syns = dict.get_entries(word);
 
 	if (!syns.size()) return;
 
@@ -887,19 +937,24 @@ namespace ukb {
   }
 
   void Kb::add_dictionary(bool with_weight) {
+	add_dictionary(WDict::instance(), with_weight);
+  }
 
-	WDict & w2syn = WDict::instance();
+  void Kb::add_dictionary(const WDict & w2syn, bool with_weight) {
 
 	vector<string>::const_iterator word_it = w2syn.get_wordlist().begin();
 	vector<string>::const_iterator word_end = w2syn.get_wordlist().end();
 
 	for(; word_it != word_end; ++word_it) {
-	  add_token(*word_it, with_weight);
+	  add_token(w2syn, *word_it, with_weight);
 	}
   }
 
-
   void Kb::add_token(const string & token, bool with_weight) {
+	add_token(WDict::instance(), token, with_weight);
+  }
+
+  void Kb::add_token(const WDict & dict, const string & token, bool with_weight) {
 
 	vector<string> wPosV;
 	map<string, vector<Syn_elem> > wPos2Syns;
@@ -907,17 +962,18 @@ namespace ukb {
 	if (glVars::input::filter_pos) {
 	  // Create w2wPos and wPos2Syns maps
 
-	  create_w2wpos_maps(token, wPosV, wPos2Syns);
+	  create_w2wpos_maps(*this, dict, token, wPosV, wPos2Syns);
 
 	  // Add vertices and link them in the KB
-	  insert_wpos(token, wPosV, wPos2Syns, with_weight);
+	  insert_wpos(*this, token, wPosV, wPos2Syns, with_weight);
 	} else {
-	  insert_word(token, with_weight);
+	  insert_word(*this, dict, token, with_weight);
 	}
   }
 
   void Kb::ppv_weights(const vector<float> & ppv) {
 
+	coef_status = 0; // reset out degree coefficients
 	graph_traits<KbGraph>::edge_iterator it, end;
 
 	tie(it, end) = edges(g);
@@ -933,8 +989,10 @@ namespace ukb {
 
   // PPV version
 
-  void Kb::pageRank_ppv(const vector<float> & ppv_map,
-						vector<float> & ranks) {
+  // Compute out-degree coefficients and the CSR in-edge structure used
+  // by pageRank. status is 1 (without weights) or 2 (with weights)
+
+  void Kb::init_coefs(char status) {
 
 	typedef graph_traits<KbGraph>::edge_descriptor edge_descriptor;
 	property_map<Kb::boost_graph_t, edge_weight_t>::type weight_map = get(edge_weight, g);
@@ -942,44 +1000,155 @@ namespace ukb {
 
 	size_t N = num_vertices(g);
 
-	if (N == ranks.size()) {
-	  std::fill(ranks.begin(), ranks.end(), 0.0);
+	out_coefs.resize(N);
+	fill(out_coefs.begin(), out_coefs.end(), 0.0);
+	if (status == 2) {
+	  N_no_isolated = prank::init_out_coefs(g, &out_coefs[0], weight_map);
 	} else {
-	  vector<float>(N, 0.0).swap(ranks); // Initialize rank vector
+	  N_no_isolated = prank::init_out_coefs(g, &out_coefs[0], cte_weight);
 	}
-	vector<float> rank_tmp(N, 0.0);    // auxiliary rank vector
-
-	if (glVars::prank::use_weight) {
-	  if(coef_status != 2) {
-		out_coefs.resize(N);
-		fill(out_coefs.begin(), out_coefs.end(), 0.0);
-		N_no_isolated = prank::init_out_coefs(g,  &out_coefs[0], weight_map);
-		coef_status = 2;
-	  }
-	} else {
-	  if(coef_status != 1) {
-		out_coefs.resize(N);
-		fill(out_coefs.begin(), out_coefs.end(), 0.0);
-		N_no_isolated = prank::init_out_coefs(g, &out_coefs[0], cte_weight);
-		coef_status = 1;
+
+	// Build CSR in-edges, keeping the order of in_edges
+	size_t E = num_edges(g);
+	vector<boost::uint32_t>(N + 1).swap(csr_offsets);
+	vector<boost::uint32_t>(E).swap(csr_sources);
+	vector<float>(E).swap(csr_coefs);
+
+	boost::uint32_t e_i = 0;
+	for(size_t v = 0; v != N; ++v) {
+	  csr_offsets[v] = e_i;
+	  graph_traits<KbGraph>::in_edge_iterator e, e_end;
+	  tie(e, e_end) = in_edges(v, g);
+	  for(; e != e_end; ++e, ++e_i) {
+		Kb_vertex_t u = source(*e, g);
+		float w = (status == 2) ? get(weight_map, *e) : 1.0f;
+		csr_sources[e_i] = u;
+		csr_coefs[e_i] = w * out_coefs[u];
 	  }
 	}
+	csr_offsets[N] = e_i;
 
-	if (glVars::prank::use_weight) {
-	  prank::do_pageRank(g, N_no_isolated, &ppv_map[0],
-						 weight_map, &ranks[0], &rank_tmp[0],
-						 glVars::prank::num_iterations,
-						 glVars::prank::threshold,
-						 glVars::prank::damping,
-						 out_coefs);
-	} else {
-	  prank::do_pageRank(g, N_no_isolated, &ppv_map[0],
-						 cte_weight, &ranks[0], &rank_tmp[0],
-						 glVars::prank::num_iterations,
-						 glVars::prank::threshold,
-						 glVars::prank::damping,
-						 out_coefs);
+	// Same for out-edges
+	vector<boost::uint32_t>(N + 1).swap(out_csr_offsets);
+	vector<boost::uint32_t>(E).swap(out_csr_targets);
+	vector<float>(E).swap(out_csr_coefs);
+
+	e_i = 0;
+	for(size_t u = 0; u != N; ++u) {
+	  out_csr_offsets[u] = e_i;
+	  graph_traits<KbGraph>::out_edge_iterator e, e_end;
+	  tie(e, e_end) = out_edges(u, g);
+	  for(; e != e_end; ++e, ++e_i) {
+		float w = (status == 2) ? get(weight_map, *e) : 1.0f;
+		out_csr_targets[e_i] = target(*e, g);
+		out_csr_coefs[e_i] = w * out_coefs[u];
+	  }
 	}
+	out_csr_offsets[N] = e_i;
+	coef_status = status;
+  }
+
+  void Kb::init_pageRank(bool with_weight) {
+	char status = with_weight ? 2 : 1;
+	if(coef_status != status) init_coefs(status);
+  }
+
+  void Kb::check_coefs(bool with_weight) const {
+	char status = with_weight ? 2 : 1;
+	if(coef_status != status)
+	  throw runtime_error("Kb::pageRank error: init_pageRank was not called with the same use_weight");
+  }
+
+  void Kb::run_pageRank(const vector<float> & ppv_map,
+						vector<float> & ranks,
+						vector<float> & rank_tmp,
+						const Kb_prank_params & params,
+						const vector<boost::uint32_t> * watch_offsets,
+						const vector<boost::uint32_t> * watch_V) const {
+
+	size_t N = num_vertices(g);
+
+	bool warm = Kb_init_ranks(N, params,
+							  static_ranks.size() == N ? &static_ranks[0] : 0,
+							  ranks, rank_tmp);
+
+	prank::csr_graph<boost::uint32_t> csr;
+	csr.N = N;
+	csr.offsets = &csr_offsets[0];
+	csr.sources = csr_sources.size() ? &csr_sources[0] : 0;
+	csr.coefs = csr_coefs.size() ? &csr_coefs[0] : 0;
+
+	prank::rank_watch<boost::uint32_t> watch;
+	watch.n = (watch_offsets && watch_offsets->size()) ? watch_offsets->size() - 1 : 0;
+	watch.offsets = watch.n ? &(*watch_offsets)[0] : 0;
+	watch.V = (watch.n && watch_V->size()) ? &(*watch_V)[0] : 0;
+	watch.patience = params.stable_iterations;
+
+	prank::do_pageRank_csr(csr, N_no_isolated, &ppv_map[0],
+						   &ranks[0], &rank_tmp[0],
+						   params.num_iterations,
+						   params.threshold,
+						   params.damping,
+						   &out_coefs[0],
+						   params.num_threads,
+						   warm,
+						   &watch);
+  }
+
+  void Kb::pageRank_ppv(const vector<float> & ppv_map,
+						vector<float> & ranks) {
+
+	if (glVars::prank::warm_start == Kb_prank_params::warm_static) static_prank();
+	init_pageRank(glVars::prank::use_weight);
+	vector<float> rank_tmp;
+	run_pageRank(ppv_map, ranks, rank_tmp, Kb_prank_params());
+  }
+
+  void Kb::pageRank_ppv(const Kb_prank_params & params,
+						Kb_workspace & ws) const {
+
+	check_coefs(params.use_weight);
+	if (ws.ppv.size() != num_vertices(g))
+	  throw runtime_error("Kb::pageRank_ppv error: personalization vector of wrong size");
+	run_pageRank(ws.ppv, ws.ranks, ws.rank_tmp, params,
+				 &ws.watch_offsets, &ws.watch_V);
+  }
+
+  // Local push version
+
+  void Kb::run_push(const vector<pair<Kb_vertex_t, float> > & ppv,
+					float epsilon,
+					float damping,
+					Kb_sparse_ranks & residual,
+					Kb_sparse_ranks & ranks) const {
+
+	ranks.clear();
+	residual.clear();
+
+	prank::csr_graph<boost::uint32_t> csr;
+	csr.N = num_vertices(g);
+	csr.offsets = &out_csr_offsets[0];
+	csr.sources = out_csr_targets.size() ? &out_csr_targets[0] : 0;
+	csr.coefs = out_csr_coefs.size() ? &out_csr_coefs[0] : 0;
+
+	prank::do_push_csr(csr, &out_coefs[0], ppv, epsilon, damping, residual, ranks);
+  }
+
+  void Kb::pageRank_push(const vector<pair<Kb_vertex_t, float> > & ppv,
+						 float epsilon,
+						 Kb_sparse_ranks & ranks) {
+
+	init_pageRank(glVars::prank::use_weight);
+	Kb_sparse_ranks residual;
+	run_push(ppv, epsilon, glVars::prank::damping, residual, ranks);
+  }
+
+  void Kb::pageRank_push(const Kb_prank_params & params,
+						 Kb_workspace & ws) const {
+
+	check_coefs(params.use_weight);
+	run_push(ws.seeds, params.push_threshold, params.damping,
+			 ws.residual, ws.sparse_ranks);
   }
 
   ////////////////////////////////////////////////////////////////////////////////
@@ -23,6 +23,8 @@
 #include <boost/property_map.hpp>
 #include <boost/graph/properties.hpp>
 
+#include <boost/unordered_map.hpp>
+
 using boost::adjacency_list;
 using boost::graph_traits;
 using boost::property;
@@ -66,6 +68,58 @@ typedef graph_traits<KbGraph>::vertex_descriptor Kb_vertex_t;
 typedef graph_traits<KbGraph>::edge_descriptor Kb_edge_t;
 typedef graph_traits < KbGraph >::vertices_size_type Kb_vertex_size_t;
 
+// sparse rank vector (vertices not present have rank zero)
+typedef boost::unordered_map<Kb_vertex_t, float> Kb_sparse_ranks;
+
+class WDict;
+
+// pageRank parameters. By default they are taken from glVars::prank,
+// but each user of a Kb may keep its own.
+
+struct Kb_prank_params {
+  bool use_weight;
+  size_t num_iterations;
+  float threshold;
+  float damping;
+  int num_threads;
+  float push_threshold;
+  int warm_start;         // one of warm_* below
+  int stable_iterations;  // if non zero, stop when the rank order of the
+                          // watched vertices is stable for this many iterations
+
+  enum {
+	warm_none = 0,        // start from uniform ranks
+	warm_static = 1,      // start from static pageRank
+	warm_previous = 2     // start from the result of the previous call
+  };
+
+  Kb_prank_params();
+};
+
+// Buffers used by the const pageRank functions of Kb. Each thread must
+// use its own workspace. Vectors are sized on first use and reused by
+// later calls.
+
+struct Kb_workspace {
+  std::vector<float> ppv;         // personalization vector
+  std::vector<float> ranks;       // resulting ranks
+  std::vector<float> rank_tmp;    // auxiliary rank vector
+  std::vector<std::pair<Kb_vertex_t, float> > seeds; // sparse personalization
+  Kb_sparse_ranks sparse_ranks;   // resulting ranks of local push
+  Kb_sparse_ranks residual;       // auxiliary residuals of local push
+  std::vector<boost::uint32_t> watch_offsets; // groups of vertices whose rank order
+  std::vector<boost::uint32_t> watch_V;       // is checked (see stable_iterations)
+};
+
+// Size ranks and rank_tmp for N vertices, and set the initial ranks
+// according to params.warm_start. static_ranks may be null if not
+// available. Returns whether ranks holds the initial ranks.
+
+bool Kb_init_ranks(size_t N, const Kb_prank_params & params,
+				   const float * static_ranks,
+				   std::vector<float> & ranks,
+				   std::vector<float> & rank_tmp);
+
 class Kb {
 
 public:
@@ -96,6 +150,13 @@ public:
 
   static void create_from_binfile(const std::string & o);
 
+  // A Kb can also be created on its own, outside the singleton, by
+  // loading a binary snapshot. This allows several graphs in the same
+  // process.
+
+  explicit Kb(const std::string & binfile);
+  ~Kb() {};
+
 
   // write_to_binfile
   // Write kb graph to a binary serialization file
@@ -124,6 +185,11 @@ public:
   void add_dictionary(bool with_weight); // Adds all words of the current dictionary
   void add_token(const std::string & str, bool with_weight); // Add just a word (lemma)
 
+  // Same, using the given dictionary instead of WDict::instance()
+
+  void add_dictionary(const WDict & dict, bool with_weight);
+  void add_token(const WDict & dict, const std::string & str, bool with_weight);
+
   // graph
   // Get the underlying boost graph
 
@@ -162,7 +228,9 @@ public:
   std::vector<std::string> get_edge_reltypes(Kb_edge_t e) const;
 
 
-  // get static pageRank
+  // get static pageRank. It is computed without edge weights, and
+  // leaves the pageRank coefficients initialized that way, so
+  // init_pageRank has to be called again after it.
 
   const std::vector<float> & static_prank() const;
 
@@ -223,6 +291,32 @@ public:
   void pageRank_ppv(const std::vector<float> & ppv_map,
 					std::vector<float> & ranks);
 
+  // Approximate personalized pageRank by local push (Andersen, Chung &
+  // Lang). ppv is the sparse personalization vector. Only vertices
+  // reached from ppv are visited, and a vertex u is pushed while its
+  // residual is at least epsilon * out_degree(u).
+
+  void pageRank_push(const std::vector<std::pair<Kb_vertex_t, float> > & ppv,
+					 float epsilon,
+					 Kb_sparse_ranks & ranks);
+
+  // Reentrant versions. The graph is not modified, so the same Kb can
+  // be shared by several threads, each one with its own workspace.
+  // init_pageRank must be called first (and after any change of the
+  // graph) with the same use_weight value later given in params.
+  //
+  // pageRank_ppv reads the personalization vector from ws.ppv and
+  // leaves the result in ws.ranks. pageRank_push reads ws.seeds and
+  // leaves the result in ws.sparse_ranks.
+
+  void init_pageRank(bool with_weight);
+
+  void pageRank_ppv(const Kb_prank_params & params,
+					Kb_workspace & ws) const;
+
+  void pageRank_push(const Kb_prank_params & params,
+					 Kb_workspace & ws) const;
+
   void ppv_weights(const std::vector<float> & ppv);
 
   // given a source node and a limit (100) return a subgraph by performing a
@@ -239,6 +333,8 @@ public:
   std::ostream & dump_graph(std::ostream & o) const;
 
 private:
+  friend class KbImage; // writes the CSR arrays to images
+
   // Singleton
   static Kb * p_instance;
   static Kb * create();
@@ -247,10 +343,25 @@ private:
   Kb() : N_no_isolated(0), coef_status(0) {};
   Kb(const Kb &) {};
   Kb &operator=(const Kb &);
-  ~Kb() {};
 
   Kb_vertex_t InsertNode(const std::string & name, unsigned char flags);
 
+  void init_coefs(char status);
+  void check_coefs(bool with_weight) const;
+
+  void run_pageRank(const std::vector<float> & ppv_map,
+					std::vector<float> & ranks,
+					std::vector<float> & rank_tmp,
+					const Kb_prank_params & params,
+					const std::vector<boost::uint32_t> * watch_offsets = 0,
+					const std::vector<boost::uint32_t> * watch_V = 0) const;
+
+  void run_push(const std::vector<std::pair<Kb_vertex_t, float> > & ppv,
+				float epsilon,
+				float damping,
+				Kb_sparse_ranks & residual,
+				Kb_sparse_ranks & ranks) const;
+
   void read_from_txt(const std::string & relFile,
 					 const std::set<std::string> & rels_source);
 
@@ -276,6 +387,14 @@ private:
   char coef_status;                      // 0 invalid
                                          // 1 calculated without weights
                                          // 2 calculated with weights
+  std::vector<boost::uint32_t> csr_offsets; // CSR in-edges of vertex v are
+                                         // [csr_offsets[v], csr_offsets[v+1])
+  std::vector<boost::uint32_t> csr_sources; // CSR source vertex of each in-edge
+  std::vector<float> csr_coefs;          // CSR edge weight * out_coefs[source]
+                                         // (valid along with coef_status)
+  std::vector<boost::uint32_t> out_csr_offsets; // same for out-edges, used by
+  std::vector<boost::uint32_t> out_csr_targets; // local push
+  std::vector<float> out_csr_coefs;
   std::vector<float> static_ranks;       // aux. vector with static prank computation
   };
 }
@@ -0,0 +1,487 @@
+#include "kbImage.h"
+#include "kbGraph.h"
+#include "wdict.h"
+#include "globalVars.h"
+#include "prank.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+// mmap
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ukb {
+
+  using namespace std;
+  using namespace boost;
+
+  ////////////////////////////////////////////////////////////////////////////////
+  // File layout
+  //
+  // The header is followed by the sections below, each one starting at
+  // an offset multiple of 8 (relative to the beginning of the file):
+  //
+  //   in_offsets   uint32[N+1]   CSR in-edges
+  //   in_sources   uint32[E]
+  //   in_coefs     float[E]
+  //   out_offsets  uint32[N+1]   CSR out-edges
+  //   out_targets  uint32[E]
+  //   out_ecoefs   float[E]
+  //   out_coefs    float[N]      out-degree coefficients (-1 isolated, 0 dangling)
+  //   static_ranks float[N]
+  //   vnames       uint32[N]     pool offset of vertex names
+  //   concepts     uint32[Nc]    concept vertices, sorted by name
+  //   words        uint32[Nw]    word vertices, sorted by name
+  //   dict_words   uint32[Nd]    pool offset of dictionary words, sorted
+  //   dict_offsets uint32[Nd+1]
+  //   dict_V       uint32[Ne]    concept vertex of each entry
+  //   dict_freq    float[Ne]
+  //   dict_pos     char[Ne]
+  //   pool         char[]        NUL terminated strings
+  //
+  // Integers are written in host byte order.
+
+  static const char image_magic[8] = {'U', 'K', 'B', 'I', 'M', 'G', '\0', '\0'};
+  static const uint32_t image_version = 1;
+
+  enum {
+	sec_in_offsets = 0, sec_in_sources, sec_in_coefs,
+	sec_out_offsets, sec_out_targets, sec_out_ecoefs,
+	sec_out_coefs, sec_static_ranks, sec_vnames,
+	sec_concepts, sec_words,
+	sec_dict_words, sec_dict_offsets, sec_dict_V, sec_dict_freq, sec_dict_pos,
+	sec_pool, sec_num
+  };
+
+  struct KbImage_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t use_weight;
+	uint32_t N;
+	uint32_t E;
+	uint32_t N_no_isolated;
+	uint32_t n_concepts;
+	uint32_t n_words;
+	uint32_t n_dict;
+	uint32_t n_entries;
+	uint32_t pool_size;
+	uint64_t file_size;
+	uint64_t offset[sec_num];
+  };
+
+  ////////////////////////////////////////////////////////////////////////////////
+  // Write
+
+  // Sort vertex ids (or pool offsets) by the string they refer to
+
+  struct pool_less {
+	pool_less(const vector<char> & p, const uint32_t * names = 0) : pool(p), vnames(names) {}
+	bool operator()(uint32_t a, uint32_t b) const {
+	  if (vnames) { a = vnames[a]; b = vnames[b]; }
+	  return strcmp(&pool[a], &pool[b]) < 0;
+	}
+	const vector<char> & pool;
+	const uint32_t * vnames;
+  };
+
+  static uint32_t pool_add(vector<char> & pool, const string & str) {
+	uint32_t off = pool.size();
+	pool.insert(pool.end(), str.begin(), str.end());
+	pool.push_back('\0');
+	return off;
+  }
+
+  template<typename T>
+  static void write_section(ofstream & fo, KbImage_header & hdr, int sec,
+							const vector<T> & v) {
+	uint64_t pos = fo.tellp();
+	static const char pad[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	if (pos % 8) {
+	  fo.write(pad, 8 - pos % 8);
+	  pos += 8 - pos % 8;
+	}
+	hdr.offset[sec] = pos;
+	if (v.size())
+	  fo.write(reinterpret_cast<const char *>(&v[0]), v.size() * sizeof(T));
+  }
+
+  void KbImage::write_image(Kb & kb, const WDict & dict, const std::string & fname) {
+
+	kb.add_dictionary(dict, glVars::dict::use_weight);
+
+	// static ranks are computed without weights, so compute them first
+	vector<float> static_ranks(kb.static_prank());
+	kb.init_pageRank(glVars::prank::use_weight);
+
+	size_t N = kb.size();
+	size_t E = kb.csr_sources.size();
+	if (N == 0)
+	  throw runtime_error("KbImage::write_image error: empty KB");
+	if (static_ranks.size() != N) vector<float>(N, 0.0).swap(static_ranks);
+
+	// vertex names
+	vector<char> pool;
+	vector<uint32_t> vnames(N);
+	for(size_t u = 0; u != N; ++u)
+	  vnames[u] = pool_add(pool, kb.get_vertex_name(u));
+
+	vector<uint32_t> concepts, words;
+	for(map<string, Kb_vertex_t>::const_iterator it = kb.synsetMap.begin();
+		it != kb.synsetMap.end(); ++it) concepts.push_back(it->second);
+	for(map<string, Kb_vertex_t>::const_iterator it = kb.wordMap.begin();
+		it != kb.wordMap.end(); ++it) words.push_back(it->second);
+	sort(concepts.begin(), concepts.end(), pool_less(pool, &vnames[0]));
+	sort(words.begin(), words.end(), pool_less(pool, &vnames[0]));
+
+	// dictionary. Only entries whose concept is in the KB are kept.
+	vector<uint32_t> dict_words;
+	for(vector<string>::const_iterator it = dict.get_wordlist().begin();
+		it != dict.get_wordlist().end(); ++it)
+	  dict_words.push_back(pool_add(pool, *it));
+	sort(dict_words.begin(), dict_words.end(), pool_less(pool));
+
+	vector<uint32_t> dict_offsets(1, 0), dict_V;
+	vector<float> dict_freq;
+	vector<char> dict_pos;
+	for(size_t i = 0; i != dict_words.size(); ++i) {
+	  WDict_entries entries = dict.get_entries(string(&pool[dict_words[i]]));
+	  for(size_t j = 0; j < entries.size(); ++j) {
+		Kb_vertex_t u;
+		bool P;
+		tie(u, P) = kb.get_vertex_by_name(entries.get_entry(j), Kb::is_concept);
+		if (!P) continue;
+		dict_V.push_back(u);
+		dict_freq.push_back(entries.get_freq(j));
+		dict_pos.push_back(entries.get_pos(j));
+	  }
+	  dict_offsets.push_back(dict_V.size());
+	}
+
+	KbImage_header hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, image_magic, sizeof(image_magic));
+	hdr.version = image_version;
+	hdr.use_weight = glVars::prank::use_weight ? 1 : 0;
+	hdr.N = N;
+	hdr.E = E;
+	hdr.N_no_isolated = kb.N_no_isolated;
+	hdr.n_concepts = concepts.size();
+	hdr.n_words = words.size();
+	hdr.n_dict = dict_words.size();
+	hdr.n_entries = dict_V.size();
+	hdr.pool_size = pool.size();
+
+	ofstream fo(fname.c_str(), ofstream::binary|ofstream::out);
+	if (!fo) {
+	  throw runtime_error("KbImage::write_image error: can't create " + fname);
+	}
+	fo.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+	write_section(fo, hdr, sec_in_offsets, kb.csr_offsets);
+	write_section(fo, hdr, sec_in_sources, kb.csr_sources);
+	write_section(fo, hdr, sec_in_coefs, kb.csr_coefs);
+	write_section(fo, hdr, sec_out_offsets, kb.out_csr_offsets);
+	write_section(fo, hdr, sec_out_targets, kb.out_csr_targets);
+	write_section(fo, hdr, sec_out_ecoefs, kb.out_csr_coefs);
+	write_section(fo, hdr, sec_out_coefs, kb.out_coefs);
+	write_section(fo, hdr, sec_static_ranks, static_ranks);
+	write_section(fo, hdr, sec_vnames, vnames);
+	write_section(fo, hdr, sec_concepts, concepts);
+	write_section(fo, hdr, sec_words, words);
+	write_section(fo, hdr, sec_dict_words, dict_words);
+	write_section(fo, hdr, sec_dict_offsets, dict_offsets);
+	write_section(fo, hdr, sec_dict_V, dict_V);
+	write_section(fo, hdr, sec_dict_freq, dict_freq);
+	write_section(fo, hdr, sec_dict_pos, dict_pos);
+	write_section(fo, hdr, sec_pool, pool);
+	hdr.file_size = fo.tellp();
+
+	fo.seekp(0);
+	fo.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+	if (!fo) {
+	  throw runtime_error("KbImage::write_image error: can't write " + fname);
+	}
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  // Load
+
+  bool KbImage::is_image(const std::string & fname) {
+	char magic[sizeof(image_magic)];
+	ifstream fi(fname.c_str(), ifstream::binary|ifstream::in);
+	if (!fi) return false;
+	fi.read(magic, sizeof(magic));
+	return fi && !memcmp(magic, image_magic, sizeof(magic));
+  }
+
+  // CSR-like offsets: off[0] is 0, they do not decrease, and off[n] is last
+
+  static bool check_offsets(const uint32_t * off, size_t n, uint32_t last) {
+	if (off[0] != 0 || off[n] != last) return false;
+	for(size_t i = 0; i != n; ++i)
+	  if (off[i] > off[i + 1]) return false;
+	return true;
+  }
+
+  // All values in v are below bound
+
+  static bool check_ids(const uint32_t * v, size_t n, uint64_t bound) {
+	for(size_t i = 0; i != n; ++i)
+	  if (v[i] >= bound) return false;
+	return true;
+  }
+
+  // Check that every section of the image fits in the file before the
+  // next one. Only the header (and the last byte of the pool) is read,
+  // so loading an image does not touch the rest of the mapped file.
+  // Returns an error description, or 0 if the layout is valid.
+
+  static const char * check_layout(const KbImage_header * hdr, const char * p) {
+
+	uint64_t N = hdr->N, E = hdr->E;
+	uint64_t Nd = hdr->n_dict, Ne = hdr->n_entries;
+	uint64_t size[sec_num];
+	size[sec_in_offsets] = (N + 1) * 4;
+	size[sec_in_sources] = E * 4;
+	size[sec_in_coefs] = E * 4;
+	size[sec_out_offsets] = (N + 1) * 4;
+	size[sec_out_targets] = E * 4;
+	size[sec_out_ecoefs] = E * 4;
+	size[sec_out_coefs] = N * 4;
+	size[sec_static_ranks] = N * 4;
+	size[sec_vnames] = N * 4;
+	size[sec_concepts] = uint64_t(hdr->n_concepts) * 4;
+	size[sec_words] = uint64_t(hdr->n_words) * 4;
+	size[sec_dict_words] = Nd * 4;
+	size[sec_dict_offsets] = (Nd + 1) * 4;
+	size[sec_dict_V] = Ne * 4;
+	size[sec_dict_freq] = Ne * 4;
+	size[sec_dict_pos] = Ne;
+	size[sec_pool] = hdr->pool_size;
+
+	uint64_t end = sizeof(KbImage_header);
+	for(int i = 0; i != sec_num; ++i) {
+	  if (hdr->offset[i] < end || hdr->offset[i] % 8) return "bad section offset";
+	  if (hdr->offset[i] > hdr->file_size) return "truncated";
+	  end = hdr->offset[i] + size[i];
+	  if (end > hdr->file_size) return "truncated";
+	}
+	if (hdr->pool_size == 0 || p[hdr->offset[sec_pool] + hdr->pool_size - 1] != '\0')
+	  return "bad name pool";
+	return 0;
+  }
+
+  // Check that offsets, vertex ids and names stay within the arrays they
+  // index. This reads the whole image, so it is only done on request
+  // (KbImage::verify), e.g. by compile_kb after writing an image.
+
+  static const char * check_contents(const KbImage_header * hdr, const char * p) {
+
+	uint64_t N = hdr->N, E = hdr->E;
+	uint64_t Nd = hdr->n_dict, Ne = hdr->n_entries;
+	const uint32_t * u32 = reinterpret_cast<const uint32_t *>(p);
+	const uint32_t * in_offsets = u32 + hdr->offset[sec_in_offsets] / 4;
+	const uint32_t * out_offsets = u32 + hdr->offset[sec_out_offsets] / 4;
+	const uint32_t * dict_offsets = u32 + hdr->offset[sec_dict_offsets] / 4;
+	if (!check_offsets(in_offsets, N, E) ||
+		!check_offsets(out_offsets, N, E) ||
+		!check_offsets(dict_offsets, Nd, Ne))
+	  return "bad CSR offsets";
+
+	if (!check_ids(u32 + hdr->offset[sec_in_sources] / 4, E, N) ||
+		!check_ids(u32 + hdr->offset[sec_out_targets] / 4, E, N) ||
+		!check_ids(u32 + hdr->offset[sec_concepts] / 4, hdr->n_concepts, N) ||
+		!check_ids(u32 + hdr->offset[sec_words] / 4, hdr->n_words, N) ||
+		!check_ids(u32 + hdr->offset[sec_dict_V] / 4, Ne, N))
+	  return "bad vertex id";
+
+	if (!check_ids(u32 + hdr->offset[sec_vnames] / 4, N, hdr->pool_size) ||
+		!check_ids(u32 + hdr->offset[sec_dict_words] / 4, Nd, hdr->pool_size))
+	  return "bad name table";
+
+	return 0;
+  }
+
+  KbImage::KbImage(const std::string & fname) : base(0), base_size(0), hdr(0) {
+
+	int fd = open(fname.c_str(), O_RDONLY);
+	if (fd < 0) {
+	  throw runtime_error("KbImage: can't open " + fname);
+	}
+	struct stat st;
+	if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(KbImage_header)) {
+	  close(fd);
+	  throw runtime_error("KbImage: " + fname + " is not a KB image");
+	}
+	base_size = st.st_size;
+	base = mmap(0, base_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) {
+	  base = 0;
+	  throw runtime_error("KbImage: can't map " + fname);
+	}
+
+	hdr = static_cast<const KbImage_header *>(base);
+	if (memcmp(hdr->magic, image_magic, sizeof(image_magic)) ||
+		hdr->version != image_version ||
+		hdr->file_size != base_size) {
+	  munmap(base, base_size);
+	  throw runtime_error("KbImage: " + fname + " is not a valid KB image");
+	}
+	const char * p = static_cast<const char *>(base);
+	const char * err = check_layout(hdr, p);
+	if (err) {
+	  munmap(base, base_size);
+	  throw runtime_error("KbImage: " + fname + " is not a valid KB image (" + err + ")");
+	}
+
+	N = hdr->N;
+	in_offsets = reinterpret_cast<const uint32_t *>(p + hdr->offset[sec_in_offsets]);
+	in_sources = reinterpret_cast<const uint32_t *>(p + hdr->offset[sec_in_sources]);
+	in_coefs = reinterpret_cast<const float *>(p + hdr->offset[sec_in_coefs]);
+	out_offsets = reinterpret_cast<const uint32_t *>(p + hdr->offset[sec_out_offsets]);
+	out_targets = reinterpret_cast<const uint32_t *>(p + hdr->offset[sec_out_targets]);
+	out_ecoefs = reinterpret_cast<const float *>(p + hdr->offset[sec_out_ecoefs]);
+	out_coefs = reinterpret_cast<const float *>(p + hdr->offset[sec_out_coefs]);
+	static_ranks = reinterpret_cast<const float *>(p + hdr->offset[sec_static_ranks]);
+	vnames = reinterpret_cast<const uint32_t *>(p + hdr->offset[sec_vnames]);
+	concepts = reinterpret_cast<const uint32_t *>(p + hdr->offset[sec_concepts]);
+	words = reinterpret_cast<const uint32_t *>(p + hdr->offset[sec_words]);
+	dict_words = reinterpret_cast<const uint32_t *>(p + hdr->offset[sec_dict_words]);
+	dict_offsets = reinterpret_cast<const uint32_t *>(p + hdr->offset[sec_dict_offsets]);
+	dict_V = reinterpret_cast<const uint32_t *>(p + hdr->offset[sec_dict_V]);
+	dict_freq = reinterpret_cast<const float *>(p + hdr->offset[sec_dict_freq]);
+	dict_pos = p + hdr->offset[sec_dict_pos];
+	pool = p + hdr->offset[sec_pool];
+  }
+
+  void KbImage::verify() const {
+	const char * err = check_contents(hdr, static_cast<const char *>(base));
+	if (err) throw runtime_error(string("KbImage: invalid KB image (") + err + ")");
+  }
+
+  KbImage::~KbImage() {
+	if (base) munmap(base, base_size);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  // Names and dictionary
+
+  const char * KbImage::get_vertex_name(Kb_vertex_t u) const {
+	return pool + vnames[u];
+  }
+
+  // Binary search of str in table, sorted by name. If names is
+  // non-null, table holds vertex ids, else pool offsets. Returns the
+  // position of str in table.
+
+  static pair<size_t, bool> find_in_table(const char * pool,
+										  const uint32_t * names,
+										  const uint32_t * table,
+										  size_t n,
+										  const char * str) {
+	size_t lo = 0, hi = n;
+	while (lo < hi) {
+	  size_t mid = lo + (hi - lo) / 2;
+	  uint32_t off = names ? names[table[mid]] : table[mid];
+	  int c = strcmp(pool + off, str);
+	  if (c == 0) return make_pair(mid, true);
+	  if (c < 0) lo = mid + 1;
+	  else hi = mid;
+	}
+	return make_pair(size_t(0), false);
+  }
+
+  pair<Kb_vertex_t, bool> KbImage::get_vertex_by_name(const std::string & str,
+													  unsigned char flags) const {
+	pair<size_t, bool> r;
+	if(flags & Kb::is_concept) {
+	  r = find_in_table(pool, vnames, concepts, hdr->n_concepts, str.c_str());
+	  if (r.second) return make_pair(Kb_vertex_t(concepts[r.first]), true);
+	}
+	// is it a word ?
+	if(flags & Kb::is_word) {
+	  r = find_in_table(pool, vnames, words, hdr->n_words, str.c_str());
+	  if (r.second) return make_pair(Kb_vertex_t(words[r.first]), true);
+	}
+	return make_pair(Kb_vertex_t(), false);
+  }
+
+  KbImage_entries KbImage::get_entries(const std::string & word) const {
+	pair<size_t, bool> r = find_in_table(pool, 0, dict_words, hdr->n_dict, word.c_str());
+	if (!r.second) return KbImage_entries();
+	uint32_t b = dict_offsets[r.first];
+	uint32_t e = dict_offsets[r.first + 1];
+	return KbImage_entries(this, dict_V + b, dict_freq + b, dict_pos + b, e - b);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  // PageRank
+
+  bool KbImage::use_weight() const {
+	return hdr->use_weight != 0;
+  }
+
+  void KbImage::check_weight(const Kb_prank_params & params) const {
+	if (params.use_weight != use_weight())
+	  throw runtime_error("KbImage::pageRank error: image was not written with the same use_weight");
+  }
+
+  void KbImage::pageRank_ppv(const Kb_prank_params & params,
+							 Kb_workspace & ws) const {
+
+	check_weight(params);
+	if (ws.ppv.size() != N)
+	  throw runtime_error("KbImage::pageRank_ppv error: personalization vector of wrong size");
+
+	bool warm = Kb_init_ranks(N, params, static_ranks, ws.ranks, ws.rank_tmp);
+
+	prank::csr_graph<uint32_t> csr;
+	csr.N = N;
+	csr.offsets = in_offsets;
+	csr.sources = in_sources;
+	csr.coefs = in_coefs;
+
+	prank::rank_watch<uint32_t> watch;
+	watch.n = ws.watch_offsets.size() ? ws.watch_offsets.size() - 1 : 0;
+	watch.offsets = watch.n ? &ws.watch_offsets[0] : 0;
+	watch.V = (watch.n && ws.watch_V.size()) ? &ws.watch_V[0] : 0;
+	watch.patience = params.stable_iterations;
+
+	prank::do_pageRank_csr(csr, hdr->N_no_isolated, &ws.ppv[0],
+						   &ws.ranks[0], &ws.rank_tmp[0],
+						   params.num_iterations,
+						   params.threshold,
+						   params.damping,
+						   out_coefs,
+						   params.num_threads,
+						   warm,
+						   &watch);
+  }
+
+  void KbImage::pageRank_push(const Kb_prank_params & params,
+							  Kb_workspace & ws) const {
+
+	check_weight(params);
+	ws.sparse_ranks.clear();
+	ws.residual.clear();
+
+	prank::csr_graph<uint32_t> csr;
+	csr.N = N;
+	csr.offsets = out_offsets;
+	csr.sources = out_targets;
+	csr.coefs = out_ecoefs;
+
+	prank::do_push_csr(csr, out_coefs, ws.seeds, params.push_threshold, params.damping,
+					   ws.residual, ws.sparse_ranks);
+  }
+
+}
@@ -0,0 +1,135 @@
+// -*-C++-*-
+
+#ifndef KBIMAGE_H
+#define KBIMAGE_H
+
+#include "kbGraph.h"
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <boost/cstdint.hpp>
+
+// Memory mapped image of a KB with the words of a dictionary already
+// added. The file holds the graph as CSR arrays (in-edges for
+// pageRank, out-edges for local push), the vertex names as sorted
+// tables and the dictionary entries as arrays of vertex ids, so that
+// nothing has to be parsed or built when loading it. All processes
+// mapping the same image share its pages.
+//
+// Images are written by compile_kb (option --image).
+
+namespace ukb {
+
+  class WDict;
+  class KbImage;
+  struct KbImage_header;
+
+  // Accessor class for the dictionary entries of a word
+
+  class KbImage_entries {
+
+  public:
+	KbImage_entries() : _img(0), _V(0), _freq(0), _pos(0), _n(0) {}
+	KbImage_entries(const KbImage * img,
+					const boost::uint32_t * V, const float * freq,
+					const char * pos, size_t n)
+	  : _img(img), _V(V), _freq(freq), _pos(pos), _n(n) {}
+
+	size_t size() const { return _n; }
+	std::string get_entry(size_t i) const;
+	Kb_vertex_t get_vertex(size_t i) const { return _V[i]; }
+	float get_freq(size_t i) const { return _freq[i]; }
+	char get_pos(size_t i) const { return _pos[i]; }
+
+  private:
+	const KbImage * _img;
+	const boost::uint32_t * _V;
+	const float * _freq;
+	const char * _pos;
+	size_t _n;
+  };
+
+  class KbImage {
+
+  public:
+
+	// Map given image file. Throws runtime_error if it can not be
+	// mapped or it is not a valid image.
+	explicit KbImage(const std::string & fname);
+	~KbImage();
+
+	// Check whether given file is a KB image
+	static bool is_image(const std::string & fname);
+
+	// Loading only checks that the sections fit in the file. This also
+	// checks their contents (offsets, vertex ids, names), reading the
+	// whole image. Throws runtime_error if they are not valid.
+	void verify() const;
+
+	// Write an image of kb after adding the words of dict. kb is
+	// modified. Edge weights are used according to glVars::dict::use_weight
+	// and glVars::prank::use_weight.
+	static void write_image(Kb & kb, const WDict & dict, const std::string & fname);
+
+	size_t size() const { return N; }
+
+	std::pair<Kb_vertex_t, bool> get_vertex_by_name(const std::string & str,
+													unsigned char flags = Kb::is_concept | Kb::is_word) const;
+	const char * get_vertex_name(Kb_vertex_t u) const;
+
+	KbImage_entries get_entries(const std::string & word) const;
+
+	// Whether edge weights were used to compute the image coefficients
+	bool use_weight() const;
+
+	// Same as Kb. params.use_weight must match use_weight().
+	void pageRank_ppv(const Kb_prank_params & params,
+					  Kb_workspace & ws) const;
+
+	void pageRank_push(const Kb_prank_params & params,
+					   Kb_workspace & ws) const;
+
+	// Static pageRank, computed when writing the image
+	const float * static_prank() const { return static_ranks; }
+
+  private:
+
+	KbImage(const KbImage &);
+	KbImage & operator=(const KbImage &);
+
+	void check_weight(const Kb_prank_params & params) const;
+
+	void * base;          // mapped file
+	size_t base_size;
+	const KbImage_header * hdr;
+
+	size_t N;
+	const boost::uint32_t * in_offsets;   // CSR in-edges
+	const boost::uint32_t * in_sources;
+	const float * in_coefs;
+	const boost::uint32_t * out_offsets;  // CSR out-edges
+	const boost::uint32_t * out_targets;
+	const float * out_ecoefs;
+	const float * out_coefs;              // out-degree coefficients
+	const float * static_ranks;
+	const boost::uint32_t * vnames;       // name of each vertex (pool offset)
+	const boost::uint32_t * concepts;     // concept vertices sorted by name
+	const boost::uint32_t * words;        // word vertices sorted by name
+	const boost::uint32_t * dict_words;   // dictionary words (pool offset), sorted
+	const boost::uint32_t * dict_offsets; // entries of dict word i are
+	                                      // [dict_offsets[i], dict_offsets[i+1])
+	const boost::uint32_t * dict_V;
+	const float * dict_freq;
+	const char * dict_pos;
+	const char * pool;                    // NUL terminated strings
+  };
+
+  inline std::string KbImage_entries::get_entry(size_t i) const {
+	return _img->get_vertex_name(_V[i]);
+  }
+
+}
+
+#endif
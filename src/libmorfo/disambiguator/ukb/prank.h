@@ -6,6 +6,12 @@
 #include <boost/graph/graph_concepts.hpp>
 #include<boost/tuple/tuple.hpp> // for "tie"
 #include <iosfwd>
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
 
 /////////////////////////////////////////////////////////////////////
 // pageRank
@@ -201,6 +207,323 @@ namespace ukb {
 	}
 
 
+	/////////////////////////////////////////////////////////////////
+	// PageRank over a compressed sparse row (CSR) in-edge structure
+	//
+	// In-edges of vertex v are stored in [offsets[v], offsets[v+1]) of
+	// the sources and coefs arrays. coefs[e] already holds the weight of
+	// edge e multiplied by the out-coefficient of its source vertex, so
+	// one step is a plain sparse matrix-vector product over contiguous
+	// arrays.
+
+	template<typename idx_t>
+	struct csr_graph {
+	  size_t N;               // number of vertices
+	  const idx_t * offsets;  // N+1 elements
+	  const idx_t * sources;  // source vertex of each in-edge
+	  const float * coefs;    // weight * out_coef[source] of each in-edge
+	};
+
+	//
+	// Vertices are updated in blocks of csr_block_size vertices. Blocks
+	// may be run in parallel (OpenMP), but each block computes its own
+	// part of the residual norm and those are added in block order, so
+	// results do not depend on the number of threads.
+	//
+
+	const size_t csr_block_size = 4096;
+	const size_t csr_lanes = 8;
+
+	//
+	// Apply one step of pageRank algorithm to vertices [v_begin, v_end)
+	// (CSR version). Return the residual norm of the block.
+	//
+
+	template<typename idx_t, typename ppvMap_t>
+	float update_pRank_csr_block(const csr_graph<idx_t> & g,
+								 size_t v_begin,
+								 size_t v_end,
+								 float damping,
+								 ppvMap_t ppv_V,
+								 const float * out_coef,
+								 const float * rank_map1,
+								 float * rank_map2) {
+
+	  float acc[csr_block_size];
+	  const size_t n = v_end - v_begin;
+
+	  // sparse product over the in-edges of the block
+	  for (size_t i = 0; i != n; ++i) {
+		float rank=0.0;
+		const idx_t e_end = g.offsets[v_begin + i + 1];
+		for(idx_t e = g.offsets[v_begin + i]; e != e_end; ++e) {
+		  rank += rank_map1[g.sources[e]] * g.coefs[e];
+		}
+		acc[i] = rank;
+	  }
+
+	  // Dense update of the block. Written without branches and with
+	  // csr_lanes independent norm accumulators so that the compiler can
+	  // vectorize it. Isolated vertices (out_coef == -1) are left
+	  // untouched and dangling ones (out_coef == 0) give back their rank.
+	  float lane_norm[csr_lanes];
+	  std::fill(lane_norm, lane_norm + csr_lanes, 0.0f);
+	  const float teleport = 1.0f - damping;
+	  size_t i = 0;
+	  for (; i + csr_lanes <= n; i += csr_lanes) {
+		for (size_t k = 0; k != csr_lanes; ++k) {
+		  const size_t v = v_begin + i + k;
+		  const float oc = out_coef[v];
+		  const float dangling_factor = (0.0f == oc) ? damping * rank_map1[v] : 0.0f;
+		  const float r = damping * acc[i + k] + (dangling_factor + teleport) * ppv_V[v];
+		  const bool isolated = (-1.0f == oc);
+		  rank_map2[v] = isolated ? rank_map2[v] : r;
+		  lane_norm[k] += isolated ? 0.0f : std::fabs(r - rank_map1[v]);
+		}
+	  }
+	  for (size_t k = 0; i != n; ++i, ++k) {
+		const size_t v = v_begin + i;
+		const float oc = out_coef[v];
+		if (-1.0f == oc) continue;
+		const float dangling_factor = (0.0f == oc) ? damping * rank_map1[v] : 0.0f;
+		rank_map2[v] = damping * acc[i] + (dangling_factor + teleport) * ppv_V[v];
+		lane_norm[k] += std::fabs(rank_map2[v] - rank_map1[v]);
+	  }
+
+	  float norm = 0.0;
+	  for (size_t k = 0; k != csr_lanes; ++k) norm += lane_norm[k];
+	  return norm;
+	}
+
+	//
+	// Apply one step of pageRank algorithm (CSR version). block_norm must
+	// have room for one element per block.
+	//
+
+	template<typename idx_t, typename ppvMap_t>
+	float update_pRank_csr(const csr_graph<idx_t> & g,
+						   float damping,
+						   ppvMap_t ppv_V,
+						   const float * out_coef,
+						   const float * rank_map1,
+						   float * rank_map2,
+						   std::vector<float> & block_norm,
+						   int threads) {
+
+	  const long n_blocks = static_cast<long>(block_norm.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(threads) if(threads > 1)
+#else
+	  (void) threads; // without OpenMP blocks are always updated sequentially
+#endif
+	  for (long b = 0; b < n_blocks; ++b) {
+		size_t v_begin = static_cast<size_t>(b) * csr_block_size;
+		size_t v_end = std::min(v_begin + csr_block_size, g.N);
+		block_norm[b] = update_pRank_csr_block(g, v_begin, v_end, damping, ppv_V,
+											   out_coef, rank_map1, rank_map2);
+	  }
+
+	  float norm = 0.0;
+	  for (long b = 0; b < n_blocks; ++b) norm += block_norm[b];
+	  return norm;
+	}
+
+	//
+	// Groups of vertices (typically, the synsets of each target word)
+	// whose rank order is checked after each iteration. If the order
+	// within every group stays the same for 'patience' iterations,
+	// iterating further will not change the disambiguation, so we stop.
+	//
+
+	template<typename idx_t>
+	struct rank_watch {
+	  size_t n;               // number of groups
+	  const idx_t * offsets;  // vertices of group i are [offsets[i], offsets[i+1])
+	  const idx_t * V;
+	  int patience;
+	};
+
+	template<typename idx_t>
+	struct rank_greater {
+	  rank_greater(const float * r) : rank(r) {}
+	  bool operator()(idx_t a, idx_t b) const {
+		return rank[a] > rank[b] || (rank[a] == rank[b] && a < b);
+	  }
+	  const float * rank;
+	};
+
+	// Sort each group of order (a copy of watch.V) according to rank.
+	// Return whether the order changed.
+
+	template<typename idx_t>
+	bool update_rank_order(const rank_watch<idx_t> & watch,
+						   const float * rank,
+						   std::vector<idx_t> & order) {
+	  bool changed = false;
+	  for (size_t i = 0; i != watch.n; ++i) {
+		typename std::vector<idx_t>::iterator b = order.begin() + watch.offsets[i];
+		typename std::vector<idx_t>::iterator e = order.begin() + watch.offsets[i + 1];
+		// groups are small, and mostly already sorted
+		for (typename std::vector<idx_t>::iterator it = b; it != e; ++it) {
+		  for (typename std::vector<idx_t>::iterator jt = it; jt != b && rank_greater<idx_t>(rank)(*jt, *(jt - 1)); --jt) {
+			std::iter_swap(jt, jt - 1);
+			changed = true;
+		  }
+		}
+	  }
+	  return changed;
+	}
+
+	//
+	// Initialize rank and iterate (CSR version)
+	//
+	// If warm is true, rank_map1 already holds the initial ranks (for
+	// instance, the solution for a similar personalization vector).
+	// If watch is given, also stop when the rank order of the watched
+	// vertices is stable.
+	//
+
+	template<typename idx_t, typename ppvMap_t>
+	void do_pageRank_csr(const csr_graph<idx_t> & g,
+						 size_t N,
+						 ppvMap_t ppv_V,
+						 float * rank_map1,
+						 float * rank_map2,
+						 int iterations,
+						 float threshold,
+						 float damping,
+						 const float * out_coef,
+						 int threads = 1,
+						 bool warm = false,
+						 const rank_watch<idx_t> * watch = 0) {
+
+	  if (N == 0) return;
+	  // an empty watch can not stop the iterations
+	  if (watch && (watch->n == 0 || watch->patience <= 0)) watch = 0;
+	  if (iterations == 0 && threshold == 0.0 && !watch)
+		throw std::runtime_error("prank error: iterations and threshold are set to zero!\n");
+	  if (!iterations) iterations = std::numeric_limits<int>::max();
+	  if (threads < 1) threads = 1;
+
+	  // Initialize rank_map1 appropriately
+	  if (!warm)
+		std::fill(rank_map1, rank_map1 + g.N, 1.0f/static_cast<float>(N));
+
+	  std::vector<idx_t> order;
+	  int stable = 0;
+	  if (watch) {
+		order.assign(watch->V, watch->V + watch->offsets[watch->n]);
+		update_rank_order(*watch, rank_map1, order);
+	  }
+
+	  std::vector<float> block_norm((g.N + csr_block_size - 1) / csr_block_size, 0.0f);
+
+	  // Continue iterating until the termination condition is met
+
+	  bool to_map_2 = true;
+	  float residual = 0.0;
+	  while(iterations--) {
+		// Update to the appropriate rank map
+		if (to_map_2)
+		  residual = update_pRank_csr(g, damping, ppv_V, out_coef, rank_map1, rank_map2, block_norm, threads);
+		else
+		  residual = update_pRank_csr(g, damping, ppv_V, out_coef, rank_map2, rank_map1, block_norm, threads);
+		// The next iteration will reverse the update mapping
+		to_map_2 = !to_map_2;
+		if (residual < threshold) break;
+		if (watch) {
+		  const float * last = to_map_2 ? rank_map1 : rank_map2;
+		  stable = update_rank_order(*watch, last, order) ? 0 : stable + 1;
+		  if (stable >= watch->patience) break;
+		}
+	  }
+
+	  // If we stopped after writing the latest results to rank_map2,
+	  // copy the results back to rank_map1 for the caller
+	  if (!to_map_2) {
+		std::copy(rank_map2, rank_map2 + g.N, rank_map1);
+	  }
+	}
+
+
+	/////////////////////////////////////////////////////////////////
+	// Approximate personalized PageRank by local push (Andersen, Chung
+	// & Lang) over a CSR out-edge structure. Here g.sources holds the
+	// target of each out-edge, and g.coefs its weight multiplied by the
+	// out-coefficient of the vertex.
+	//
+	// Residual mass is pushed from a vertex while it is over epsilon
+	// times its out degree. Dangling vertices give their mass back to
+	// the personalization vector. ranks and residual must be empty.
+
+	template<typename idx_t, typename seeds_t, typename sparseMap_t>
+	void do_push_csr(const csr_graph<idx_t> & g,
+					 const float * out_coef,
+					 const seeds_t & ppv,
+					 float epsilon,
+					 float damping,
+					 sparseMap_t & residual,
+					 sparseMap_t & ranks) {
+
+	  typedef typename seeds_t::const_iterator seeds_iterator;
+	  typedef typename sparseMap_t::iterator residual_iterator;
+
+	  if (ppv.empty()) return;
+	  if (epsilon <= 0.0)
+		throw std::runtime_error("pageRank_push error: epsilon must be positive!");
+
+	  std::deque<idx_t> Q; // vertices whose residual is over threshold
+
+	  seeds_iterator pv_it;
+	  seeds_iterator pv_end = ppv.end();
+	  for(pv_it = ppv.begin(); pv_it != pv_end; ++pv_it) {
+		residual[pv_it->first] += pv_it->second;
+	  }
+	  for(residual_iterator it = residual.begin(); it != residual.end(); ++it) {
+		idx_t deg = g.offsets[it->first + 1] - g.offsets[it->first];
+		if (it->second >= epsilon * std::max(deg, idx_t(1)))
+		  Q.push_back(it->first);
+	  }
+
+	  while(!Q.empty()) {
+		idx_t u = Q.front();
+		Q.pop_front();
+
+		float & r_u = residual[u];
+		float push = r_u;
+		r_u = 0.0;
+		float oc = out_coef[u];
+		if (-1.0 == oc) continue; // isolated vertex
+		ranks[u] += (1.0 - damping) * push;
+		push *= damping;
+
+		if (0.0 == oc) {
+		  // dangling vertex: its rank goes back to the personalization vector
+		  for(pv_it = ppv.begin(); pv_it != pv_end; ++pv_it) {
+			float & r_v = residual[pv_it->first];
+			idx_t deg = g.offsets[pv_it->first + 1] - g.offsets[pv_it->first];
+			float thr = epsilon * std::max(deg, idx_t(1));
+			bool below = r_v < thr;
+			r_v += push * pv_it->second;
+			if (below && r_v >= thr) Q.push_back(pv_it->first);
+		  }
+		  continue;
+		}
+
+		for(idx_t e = g.offsets[u], e_end = g.offsets[u + 1]; e != e_end; ++e) {
+		  idx_t v = g.sources[e];
+		  float & r_v = residual[v];
+		  idx_t deg = g.offsets[v + 1] - g.offsets[v];
+		  float thr = epsilon * std::max(deg, idx_t(1));
+		  bool below = r_v < thr;
+		  r_v += push * g.coefs[e];
+		  if (below && r_v >= thr) Q.push_back(v);
+		}
+	  }
+	}
+
+
 	/////////////////////////////////////////////////////////////////
 	// PageRank iteration
 	//
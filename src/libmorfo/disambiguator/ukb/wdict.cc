@@ -182,6 +182,10 @@ namespace ukb {
 	read_wdict_file(glVars::dict_filename, words, m_wdicts);
   }
 
+  WDict::WDict(const std::string & fname) {
+	read_wdict_file(fname, words, m_wdicts);
+  }
+
   WDict & WDict::instance() {
 	static WDict inst;
 	return inst;
@@ -48,6 +48,9 @@ namespace ukb {
 	// Singleton
 	static WDict & instance();
 
+	// Stand-alone dictionary read from fname
+	explicit WDict(const std::string & fname);
+
 	WDict_entries get_entries(const std::string & word) const;
 
 
@@ -28,6 +28,7 @@
 
 #include <sstream>
 #include <fstream>
+#include <algorithm>
 
 #include "freeling/locutions.h"
 #include "fries/util.h"
@@ -67,6 +68,9 @@ locutions::locutions(const std::string &locFile): automat()
 {
   string line;
 
+  // create trie root
+  trie.push_back(loc_node());
+
   if (locFile!="") { // if no file given, wait for later manual locution loading
     // open locutions file
     ifstream fabr (locFile.c_str());
@@ -74,7 +78,7 @@ locutions::locutions(const std::string &locFile): automat()
       ERROR_CRASH("Error opening file "+locFile);
     }
     
-    // loading locutions and prefixes map
+    // loading locutions into the trie
     while (getline(fabr, line))
       add_locution(line);
     
@@ -86,11 +90,7 @@ locutions::locutions(const std::string &locFile): automat()
   
   // Initialize Final state set 
   Final.insert(M);
-  
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-  
+
   // Initializing transitions table
   // State P
   trans[P][TK_pref]=P; trans[P][TK_mw]=M;   
@@ -110,12 +110,13 @@ locutions::locutions(const std::string &locFile): automat()
 ///////////////////////////////////////////////////////////////
 
 void locutions::add_locution(const std::string &line) {
-string prefix, key, lemma, tag;
-string::size_type p;   
+string key, lemma, tag;
+string::size_type p,q;   
 
   istringstream sin;
   sin.str(line);
   sin>>key;
+  if (key.empty()) return;
 
   // read first pair lemma-tag
   sin>>lemma>>tag;  string data = lemma+" "+tag;
@@ -126,56 +127,109 @@ string::size_type p;
     i=1-i;
   }
   
-  // store multiword in multiwords map
-  locut.insert(make_pair(key,data));
-  
-  // store all its prefixes (xxx_, xxx_yyy_, xxx_yyy_zzz_, ...) in prefixes map 
-  prefix="";
-  p = key.find_first_of("_");
-  while (p!=string::npos) {
-    
-    prefix += key.substr(0,p+1);                         	 
-    prefixes.insert(prefix);  
-    
-    key = key.substr(p+1);
-    p = key.find_first_of("_");
-  }  
+  // store multiword in the trie, one node per component (xxx, xxx_yyy, xxx_yyy_zzz, ...)
+  int node=0;
+  p=0;
+  do {
+    q = key.find_first_of("_",p);
+    int sym = get_symbol(key.substr(p, q==string::npos ? string::npos : q-p));
+
+    map<int,int>::const_iterator n=trie[node].next.find(sym);
+    if (n!=trie[node].next.end()) node=n->second;
+    else {
+      int k=trie.size();
+      trie[node].next.insert(make_pair(sym,k));
+      trie.push_back(loc_node());
+      node=k;
+    }
+    p=q+1;
+  } while (q!=string::npos);
+
+  // if the locution is repeated, the first entry is kept
+  if (trie[node].key.empty()) {
+    trie[node].key=key;
+    trie[node].data=data;
+  }
 }
 
 
-//-- Implementation of virtual functions from class automat --//
+///////////////////////////////////////////////////////////////
+///  Get the symbol code for a key component, creating a new
+///  one if it didn't exist. Components like "<lemma>" are
+///  coded apart, so lemmas are looked up without building strings.
+///////////////////////////////////////////////////////////////
 
+int locutions::get_symbol(const std::string &s) {
 
-void locutions::check(const string s, set<string> &acc, bool &mw, bool &pref) 
-{  
-  if (locut.find(s)!=locut.end()) {
-    acc.insert(s); 
-    longest_mw=acc;
-    over_longest=0;
-    TRACE(3,"  Added MW: "+s);
-    mw=true;
-  }
-  else if (prefixes.find(s+"_")!=prefixes.end()) {
-    acc.insert(s); 
-    TRACE(3,"  Added PRF: "+s);
-    pref=true;
+  bool lem = (s.size()>2 && s[0]=='<' && s[s.size()-1]=='>');
+  map<string,int> &m = (lem ? lemma_symbols : symbols);
+  string k = (lem ? s.substr(1,s.size()-2) : s);
+
+  map<string,int>::const_iterator p=m.find(k);
+  if (p!=m.end()) return p->second;
+
+  int code=symbols.size()+lemma_symbols.size();
+  m.insert(make_pair(k,code));
+  return code;
+}
+
+
+///////////////////////////////////////////////////////////////
+///  Get the symbol path for a word form or tag (or a lemma,
+///  if lem is true), splitting it in components as locution keys 
+///  are. Return false if some component is not in any locution.
+///////////////////////////////////////////////////////////////
+
+bool locutions::get_path(const std::string &s, bool lem, std::vector<int> &path) const {
+  map<string,int>::const_iterator x;
+
+  path.clear();
+  if (lem && s.find_first_of("_")==string::npos) {
+    // usual case, lemma is a single component.
+    x=lemma_symbols.find(s);
+    if (x==lemma_symbols.end()) return false;
+    path.push_back(x->second);
+    return true;
   }
+
+  string w = (lem ? "<"+s+">" : s);
+  string::size_type p=0,q;
+  do {
+    q = w.find_first_of("_",p);
+    string c = w.substr(p, q==string::npos ? string::npos : q-p);
+    if (c.size()>2 && c[0]=='<' && c[c.size()-1]=='>') {
+      x=lemma_symbols.find(c.substr(1,c.size()-2));
+      if (x==lemma_symbols.end()) return false;
+    }
+    else {
+      x=symbols.find(c);
+      if (x==symbols.end()) return false;
+    }
+    path.push_back(x->second);
+    p=q+1;
+  } while (q!=string::npos);
+
+  return true;
 }
 
 
+//-- Implementation of virtual functions from class automat --//
+
+
 ///////////////////////////////////////////////////////////////
 ///  Compute the right token code for word j from given state.
 ///////////////////////////////////////////////////////////////
 
 int locutions::ComputeToken(int state, sentence::iterator &j, sentence &se)
 {
-  set<string> acc;
-  set<string>::const_iterator i;
-  string form, lem, tag;
+  set<int> acc,found;
+  set<int>::const_iterator i;
+  vector<vector<int> > alts;
+  vector<int> path;
+  string form;
   word::const_iterator a;
   int token;
   bool mw,pref;
-  string s;
  
   // store component
   components.push_back(*j);
@@ -183,57 +237,55 @@ int locutions::ComputeToken(int state, sentence::iterator &j, sentence &se)
   
   token = TK_other;
 
-  // look for first analysis matching some locution or prefix
+  // get symbol paths for the form, and for lemma and tag of each analysis
+  TRACE(3,"checking ("+form+")");
+  if (get_path(form,false,path)) alts.push_back(path);
+  for (a=j->begin(); a!=j->end(); a++) {
+    TRACE(3,"checking (<"+a->get_lemma()+">,"+a->get_parole()+")");
+    if (get_path(a->get_lemma(),true,path)) alts.push_back(path);
+    if (get_path(a->get_parole(),false,path)) alts.push_back(path);
+  }
+
+  // advance all active trie nodes (or the root, if starting) with each path.
+  if (acc_mw.empty()) acc_mw.insert(0);
 
-  // if no analysis, check only the form
   mw=false; pref=false;
-  if (j->size() == 0) {
-      TRACE(3,"checking ("+form+")");
-      if (acc_mw.empty()) {
-	check(form,acc,mw,pref); 
-      }
-      else {
-	for (i=acc_mw.begin(); i!=acc_mw.end(); i++) {
-	  TRACE(3,"   acc_mw: ["+(*i)+"]");
-	  check((*i)+"_"+form,acc,mw,pref); 
-	}
+  for (i=acc_mw.begin(); i!=acc_mw.end(); i++) {
+    for (vector<vector<int> >::const_iterator t=alts.begin(); t!=alts.end(); t++) {
+
+      int n=*i;
+      for (vector<int>::const_iterator c=t->begin(); c!=t->end() && n>=0; c++) {
+	map<int,int>::const_iterator x=trie[n].next.find(*c);
+	n = (x==trie[n].next.end() ? -1 : x->second);
       }
-  }
-  else { // there are analysis, check all multiword patterns
-    for (a=j->begin(); a!=j->end(); a++) {
-      bool bm=false,bp=false;
-      lem = "<"+a->get_lemma()+">";
-      tag = a->get_parole();
-      TRACE(3,"checking ("+form+","+lem+","+tag+")");
-      
-      if (acc_mw.empty()) {
-	check(form,acc,bm,bp); 
-	check(lem,acc,bm,bp);  
-	check(tag,acc,bm,bp);  
-	mw=mw||bm; pref=pref||bp; 
+      if (n<0) continue;
+
+      acc.insert(n);
+      if (not trie[n].key.empty()) {
+	TRACE(3,"  Added MW: "+trie[n].key);
+	found.insert(n);
+	mw=true;
       }
       else {
-	for (i=acc_mw.begin(); i!=acc_mw.end(); i++) {
-	  TRACE(3,"   acc_mw: ["+(*i)+"]");
-	  check((*i)+"_"+form,acc,bm,bp); 
-	  check((*i)+"_"+lem,acc,bm,bp);  
-	  check((*i)+"_"+tag,acc,bm,bp);  
-	  mw=mw||bm; pref=pref||bp; 
-	}
+	TRACE(3,"  Added PRF");
+	pref=true;
       }
     }
   }
 
   TRACE(3," fora: "+(mw?string("MW"):string("noMW"))+","+(pref?string("PREF"):string("noPREF")));
 
-
-  if (mw) token=TK_mw;
+  if (mw) {
+    token=TK_mw;
+    longest_mw=found;
+    over_longest=0;
+  }
   else if (pref) token=TK_pref;
 
   over_longest++;
   acc_mw = acc;
 
-  TRACE(3,"Encoded word: ["+form+","+lem+","+tag+"] token="+util::int2string(token));
+  TRACE(3,"Encoded word: ["+form+"] token="+util::int2string(token));
   return (token);
 }
 
@@ -263,8 +315,8 @@ void locutions::StateActions(int origin, int state, int token, sentence::const_i
 
 #ifdef VERBOSE
   TRACE(3,"State actions completed. LMWs are:");
-  for (set<string>::iterator m=longest_mw.begin(); m!=longest_mw.end(); m++)
-    TRACE(3,"                                "+*m);
+  for (set<int>::iterator m=longest_mw.begin(); m!=longest_mw.end(); m++)
+    TRACE(3,"                                "+trie[*m].key);
 #endif
 
 }
@@ -277,7 +329,6 @@ void locutions::StateActions(int origin, int state, int token, sentence::const_i
 bool locutions::ValidMultiWord(const word & w) {
 
   string form,lemma,tag,check,par;
-  map<string,string>::const_iterator mw_data;
   unsigned int nc;
   string::size_type p;
   word::const_iterator a;
@@ -290,55 +341,55 @@ bool locutions::ValidMultiWord(const word & w) {
   
   TRACE(3," longest_mw #candidates: ("+util::int2string(longest_mw.size())+")");
 
-  // consider all possible matching MWs
-  for (set<string>::iterator m=longest_mw.begin(); m!=longest_mw.end(); m++ ) {
+  // consider all possible matching MWs, sorted by key
+  vector<pair<string,int> > matched;
+  for (set<int>::iterator m=longest_mw.begin(); m!=longest_mw.end(); m++ )
+    matched.push_back(make_pair(trie[*m].key,*m));
+  sort(matched.begin(),matched.end());
 
-    string form=*m;
+  for (vector<pair<string,int> >::iterator m=matched.begin(); m!=matched.end(); m++ ) {
 
-    if (locut.find(form)!=locut.end()) {  // only bother if it's a real MW, not a prefix.
-    
-      TRACE(3," matched locution: ("+form+")");
+    string form=m->first;
+    TRACE(3," matched locution: ("+form+")");
       
-      // MW matched, recover its tags and add them to the list.
-      mw_data=locut.find(form);
-      list<string> ldata = util::string2list(mw_data->second,"#");
+    // MW matched, recover its tags and add them to the list.
+    list<string> ldata = util::string2list(trie[m->second].data,"#");
       
-      for (list<string>::const_iterator k=ldata.begin(); k!=ldata.end(); k++) {
+    for (list<string>::const_iterator k=ldata.begin(); k!=ldata.end(); k++) {
 	
-	istringstream sin;
-	sin.str(*k);
-	sin>>lemma>>tag;
+      istringstream sin;
+      sin.str(*k);
+      sin>>lemma>>tag;
 	
-	// the tag is straighforward, use as is.
-	if (tag[0]!='$') {
-	  la.push_back(analysis(lemma,tag));    
-	  valid = true;
-	}
-	else {
-	  // the tag is NOT straighforward, must be recovered from the components
+      // the tag is straighforward, use as is.
+      if (tag[0]!='$') {
+	la.push_back(analysis(lemma,tag));    
+	valid = true;
+      }
+      else {
+	// the tag is NOT straighforward, must be recovered from the components
 	  
-	  // locate end of component number, and extract the number
-	  p = tag.find(":",0);
-	  if (p==string::npos) ERROR_CRASH("Invalid tag in locution entry: "+form+" "+lemma+" "+tag);
-	  check=tag.substr(p+1);
-	  // get the condition on the PoS after the component number (e.g. $1:NC)
-	  nc=util::string2int(tag.substr(1,p-1));
-	  TRACE(3,"Getting tag from word $"+util::int2string(nc)+", constraint: "+check);
+	// locate end of component number, and extract the number
+	p = tag.find(":",0);
+	if (p==string::npos) ERROR_CRASH("Invalid tag in locution entry: "+form+" "+lemma+" "+tag);
+	check=tag.substr(p+1);
+	// get the condition on the PoS after the component number (e.g. $1:NC)
+	nc=util::string2int(tag.substr(1,p-1));
+	TRACE(3,"Getting tag from word $"+util::int2string(nc)+", constraint: "+check);
 	  
-	  // search all analysis in the given component that match the PoS condition,
-	  bool found=false;
-	  for (a=components[nc-1].begin(); a!=components[nc-1].end(); a++) { 
-	    TRACE(4,"  checking analysis: "+a->get_lemma()+" "+a->get_parole());
-	    par=a->get_parole();
-	    if (par.find(check)==0) {
-	      found=true;
-	      la.push_back(analysis(lemma,par));
-	    }
+	// search all analysis in the given component that match the PoS condition,
+	bool found=false;
+	for (a=components[nc-1].begin(); a!=components[nc-1].end(); a++) { 
+	  TRACE(4,"  checking analysis: "+a->get_lemma()+" "+a->get_parole());
+	  par=a->get_parole();
+	  if (par.find(check)==0) {
+	    found=true;
+	    la.push_back(analysis(lemma,par));
 	  }
-	  
-	  if (!found) TRACE(2,"Validation Failed: Tag "+tag+" not found in word. Locution entry: "+form+" "+lemma+" "+tag);
-	  valid = found;
 	}
+	  
+	if (!found) TRACE(2,"Validation Failed: Tag "+tag+" not found in word. Locution entry: "+form+" "+lemma+" "+tag);
+	valid = found;
       }
     }
   }
@@ -82,84 +82,45 @@ maco::~maco() {
 }
 
 
+///////////////////////////////////////////////////////////////
+///  Analyze given sentence with all active modules. 
+///  All modules work on one sentence at a time, so running them all 
+///  over a sentence before moving to the next gives the same results
+///  than running each module over the whole list, while the sentence
+///  is still in cache. Callers may also use this to pass each sentence
+///  to next analysis steps as soon as it is ready.
+///////////////////////////////////////////////////////////////  
+
+void maco::analyze(sentence &s) {
+
+  // (Skipping number detection will affect dates and quantities modules)
+  if (defaultOpt.NumbersDetection) numb->annotate(s);
+  if (defaultOpt.PunctuationDetection) punt->annotate(s);
+  if (defaultOpt.DatesDetection) date->annotate(s);
+  // (Skipping dictionary search will also skip suffix analysis)
+  if (defaultOpt.DictionarySearch) dico->annotate(s);
+  if (defaultOpt.MultiwordsDetection) loc->annotate(s);
+  if (defaultOpt.NERecognition!=NER_NONE) npm->annotate(s);
+  if (defaultOpt.QuantitiesDetection) quant->annotate(s);
+  if (defaultOpt.OrthographicCorrection) correct->annotate(s);
+  if (defaultOpt.ProbabilityAssignment) prob->annotate(s);
+
+  // mark all analysis of each word as selected (taggers assume it's this way)
+  for (sentence::iterator w=s.begin(); w!=s.end(); w++)
+    w->select_all_analysis();
+
+  TRACE(2,"Sentence annotated by all active modules.");
+}
+
+
 ///////////////////////////////////////////////////////////////
 ///  Analyze given sentences.
 ///////////////////////////////////////////////////////////////  
 
 void maco::analyze(std::list<sentence> &ls) {
-  list<sentence>::iterator is;
-  
-     if (defaultOpt.NumbersDetection){ 
-       // (Skipping number detection will affect dates and quantities modules)
-       for (is=ls.begin(); is!=ls.end(); is++) {
-	 numb->annotate(*is);    
-       }    
-       TRACE(2,"Sentences annotated by the numbers module.");
-     }
-
-     if(defaultOpt.PunctuationDetection){ 
-       for (is=ls.begin(); is!=ls.end(); is++) {
-	 punt->annotate(*is);    
-       }
-     }
-     TRACE(2,"Sentences annotated by the punts module.");
-     
-     if(defaultOpt.DatesDetection) { 
-       for (is=ls.begin(); is!=ls.end(); is++) {
-	 date->annotate(*is);    
-       }    
-       TRACE(2,"Sentences annotated by the dates module.");
-     }
-
-     if(defaultOpt.DictionarySearch) {
-       // (Skipping dictionary search will also skip suffix analysis)
-       for (is=ls.begin(); is!=ls.end(); is++) {
-	 dico->annotate(*is);
-       }   
-       TRACE(2,"Sentence annotated by the dictionary searcher.");
-     }
-
-     // annotate list of sentences with required modules
-     if (defaultOpt.MultiwordsDetection) { 
-       for (is=ls.begin(); is!=ls.end(); is++) {
-	 loc->annotate(*is);
-       }
-       TRACE(2,"Sentences annotated by the locutions module.");
-     }
-
-     if(defaultOpt.NERecognition!=NER_NONE){ 
-       for (is=ls.begin(); is!=ls.end(); is++) {
-	 npm->annotate(*is);
-       }    
-       TRACE(2,"Sentences annotated by the np module.");
-     }
-
-     if(defaultOpt.QuantitiesDetection){
-       for (is=ls.begin(); is!=ls.end(); is++) {
-	 quant->annotate(*is);    
-       }    
-       TRACE(2,"Sentences annotated by the quantities module.");
-     }
-
-     if (defaultOpt.OrthographicCorrection){
-       for (is=ls.begin(); is!=ls.end(); is++) {
-	 correct->annotate(*is);
-       }
-       TRACE(2,"Orthographic correction of the sentence.");
-     }
-     
-
-     if (defaultOpt.ProbabilityAssignment) {
-       for (is=ls.begin(); is!=ls.end(); is++) {
-	 prob->annotate(*is);    
-       }    
-       TRACE(2,"Sentences annotated by the probabilities module.");
-     }
-
-     // mark all analysis of each word as selected (taggers assume it's this way)
-     for (is=ls.begin(); is!=ls.end(); is++)
-       for (sentence::iterator w=is->begin(); w!=is->end(); w++)
-	 w->select_all_analysis();
+
+  for (list<sentence>::iterator is=ls.begin(); is!=ls.end(); is++) 
+    analyze(*is);
 }
 
 ///////////////////////////////////////////////////////////////
@@ -54,7 +54,7 @@ nec::nec(const std::string &tag, const std::string &filepref) : NPtag(tag)
 
   // create AdaBoost classifier
   TRACE(3," Loading adaboost model "+filepref+".abm");
-  classifier = new adaboost(filepref+".abm");
+  classifier = new compiled_adaboost(filepref+".abm");
    
   TRACE(3,"analyzer succesfully created");
 }
@@ -75,15 +75,15 @@ void nec::analyze(std::list<sentence> &ls) const {
   list<sentence>::iterator se;
   sentence::iterator w;
   word::iterator a;
-  set<int>::iterator f;
   vector<set<int> > features;
   map<string,int>::const_iterator p;  
   int i,j;
   double max;
   string tag,def;
 
-  // allocate prediction array (reused for all sentences)
+  // allocate prediction array and classifier buffers (reused for all sentences)
   double pred[classifier->get_nlabels()];
+  compiled_adaboost::workspace ws;
 
   for (se=ls.begin(); se!=ls.end(); se++) {
     
@@ -99,14 +99,10 @@ void nec::analyze(std::list<sentence> &ls) const {
       for (a=w->selected_begin(); a!=w->selected_end(); a++) {
 	if (a->get_parole().find(NPtag,0)==0) {
 	  
-	  TRACE(2,"NP found ("+w->get_form()+"). building example");
-	  example exmp(classifier->get_nlabels());
-	  // add all extracted features to example
-	  for (f=features[i].begin(); f!=features[i].end(); f++) exmp.add_feature(*f);
-	  TRACE(3,"   example build, with "+util::int2string(exmp.size())+" features");
+	  TRACE(2,"NP found ("+w->get_form()+"). classifying example with "+util::int2string(features[i].size())+" features");
 	  
 	  // classify example
-	  classifier->classify(exmp,pred);
+	  classifier->classify(features[i],pred,ws);
 	  TRACE(2,"Example classified");
 	  
 	  // find out which class has highest weight,
@@ -138,11 +138,7 @@ np::np(const std::string &npFile): ner(), automat(), RE_NounAdj(RE_NA), RE_Close
   initialState=IN; stopState=STOP;
   // Initialize Final state set 
   Final.insert(NP); 
-  
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-  
+
   // Initializing transitions table
   // State IN
   trans[IN][TK_sUnkUpp]=NP; trans[IN][TK_sNounUpp]=NP; trans[IN][TK_mUpper]=NP;
@@ -344,20 +340,13 @@ void np::SetMultiwordAnalysis(sentence::iterator i, int fstate) {
 
 sentence::iterator np::BuildMultiword(sentence &se, sentence::iterator start, sentence::iterator end, int fs, bool &built)
 {
-	sentence::iterator i;
+	sentence::iterator i,next;
 	list<word> mw;
 	string form;
 	
 	TRACE(3,"Building multiword");
-	for (i=start; i!=end; i++){
-		mw.push_back(*i);           
-		form += i->get_form()+"_";
-		TRACE(3,"added next ["+form+"]");
-	} 
-	// don't forget last word
-	mw.push_back(*i);           
-	form += i->get_form();
-	TRACE(3,"added last ["+form+"]");
+	// move the words out of the sentence
+	next=SpliceMultiword(se,start,end,mw,form);
 	
 	// build new word with the mw list, and check whether it is acceptable
 	word w(form,mw);
@@ -365,6 +354,8 @@ sentence::iterator np::BuildMultiword(sentence &se, sentence::iterator start, se
 	if (ValidMultiWord(w)) {  
 	  if (splitNPs) {
 	    TRACE(3,"Valid Multiword. Split NP is on: keeping separate words");
+	    // put the words back in place
+	    se.splice(next,mw);
 	    for (sentence::iterator j=start; j!=end; j++) {
 	      if (util::isuppercase(j->get_form()[0]))
 		j->set_analysis(analysis(util::lowercase(j->get_form()),NE_tag));
@@ -379,11 +370,8 @@ sentence::iterator np::BuildMultiword(sentence &se, sentence::iterator start, se
 	  }
 	  else {
 	    TRACE(3,"Valid Multiword. Modifying the sentence");
-	    // erasing from the sentence the words that composed the multiword
-	    end++;
-	    i=se.erase(start, end);
-	    // insert new multiword it into the sentence
-	    i=se.insert(i,w); 
+	    // insert new multiword into the sentence, where the words were
+	    i=se.insert(next,w); 
 	    TRACE(3,"New word inserted");
 	    // Set morphological info for new MW
 	    SetMultiwordAnalysis(i,fs);
@@ -392,6 +380,8 @@ sentence::iterator np::BuildMultiword(sentence &se, sentence::iterator start, se
 	}
 	else {
 	  TRACE(3,"Multiword found, but rejected. Sentence untouched");
+	  // put the words back in place
+	  se.splice(next,mw);
 	  ResetActions();
 	  i=start;
 	  built=false;
@@ -44,6 +44,12 @@ numbers_module::numbers_module(const std::string &dec, const std::string &thou):
                                                                        RE_code(RE_CODE)
 {}
 
+// Bits to store regex results in word classification.
+// Both regexes require some digit in the form, so they are 
+// only run on forms containing one.
+#define RX_NUM   1   // form matches RE_NUM
+#define RX_CODE  2   // form matches RE_CODE
+
 
 //-----------------------------------------------//
 //        Default number recognizer              //
@@ -75,10 +81,6 @@ numbers_default::numbers_default(const std::string &dec, const std::string &thou
   // Initialize Final state set 
   Final.insert(NUM);  Final.insert(COD);
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-  
   // Initializing transitions table
   // State A
   trans[A][TK_num]=NUM;  trans[A][TK_code]=COD;
@@ -99,14 +101,15 @@ numbers_default::numbers_default(const std::string &dec, const std::string &thou
 
 int numbers_default::ComputeToken(int state, sentence::iterator &j, sentence &se)
 {
-  string form;
   int token;
  
-  form = util::lowercase(j->get_form());
+  // get word classification (computed once per sentence)
+  token_class &tc=classify(j);
+  const string &form=tc.lcform;
   
   // check to see if it is a number
-  if (RE_number.Search(form)) token = TK_num;
-  else if (RE_code.Search(form)) token = TK_code;
+  if (tc.digit && check_regex(j,RX_NUM,RE_number)) token = TK_num;
+  else if (tc.digit && check_regex(j,RX_CODE,RE_code)) token = TK_code;
   else token = TK_other;
 
   TRACE(3,"Next word form is: ["+form+"] token="+util::int2string(token));     
@@ -394,10 +397,6 @@ numbers_es::numbers_es(const std::string &dec, const std::string &thou): numbers
   Final.insert(M1b); Final.insert(S1b); Final.insert(COD);  
   Final.insert(X1);  Final.insert(X3);  Final.insert(X5);
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-  
   // Initializing transitions table
   // State B1
   trans[B1][TK_c]=B2;   trans[B1][TK_d]=B3;   trans[B1][TK_u]=Bu; 
@@ -511,11 +510,12 @@ numbers_es::numbers_es(const std::string &dec, const std::string &thou): numbers
 
 int numbers_es::ComputeToken(int state, sentence::iterator &j, sentence &se)
 {
-  string form;
   int token;
   map<string,int>::iterator im;
  
-  form = util::lowercase(j->get_form());
+  // get word classification (computed once per sentence)
+  token_class &tc=classify(j);
+  const string &form=tc.lcform;
   
   token = TK_other;
   im = tok.find(form);
@@ -529,8 +529,8 @@ int numbers_es::ComputeToken(int state, sentence::iterator &j, sentence &se)
 
   // Token not found in translation table, let's have a closer look.
   // check to see if it is a number
-  if (RE_number.Search(form)) token = TK_num;
-  else if (RE_code.Search(form)) token = TK_code;
+  if (tc.digit && check_regex(j,RX_NUM,RE_number)) token = TK_num;
+  else if (tc.digit && check_regex(j,RX_CODE,RE_code)) token = TK_code;
 
   TRACE(3,"Leaving state "+util::int2string(state)+" with token "+util::int2string(token)); 
   return (token);
@@ -993,10 +993,6 @@ numbers_ca::numbers_ca(const std::string &dec, const std::string &thou): numbers
   Final.insert(S5);  Final.insert(S6);  Final.insert(S7);  Final.insert(Sk);
   Final.insert(M1b); Final.insert(S1b); Final.insert(COD);  
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-  
   // Initializing transitions table
   // State B1
   trans[B1][TK_c]=B2;   trans[B1][TK_d]=B3;   trans[B1][TK_u]=Bu; 
@@ -1095,11 +1091,12 @@ numbers_ca::numbers_ca(const std::string &dec, const std::string &thou): numbers
 
 int numbers_ca::ComputeToken(int state, sentence::iterator &j, sentence &se)
 {
-  string form;
   int token;
   map<string,int>::iterator im;
  
-  form = util::lowercase(j->get_form());
+  // get word classification (computed once per sentence)
+  token_class &tc=classify(j);
+  const string &form=tc.lcform;
   
   token = TK_other;
   im = tok.find(form);
@@ -1113,8 +1110,8 @@ int numbers_ca::ComputeToken(int state, sentence::iterator &j, sentence &se)
 
   // Token not found in translation table, let's have a closer look.
   // check to see if it is a number
-  if (RE_number.Search(form)) token = TK_num;
-  else if (RE_code.Search(form)) token = TK_code;
+  if (tc.digit && check_regex(j,RX_NUM,RE_number)) token = TK_num;
+  else if (tc.digit && check_regex(j,RX_CODE,RE_code)) token = TK_code;
 
   TRACE(3,"Leaving state "+util::int2string(state)+" with token "+util::int2string(token)); 
   return (token);
@@ -1467,10 +1464,6 @@ numbers_gl::numbers_gl(const std::string &dec, const std::string &thou): numbers
   Final.insert(M1b); Final.insert(S1b); Final.insert(COD);  
   Final.insert(X1);  Final.insert(X3);  Final.insert(X5);
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-  
   // Initializing transitions table
   // State B1
   trans[B1][TK_c]=B2;   trans[B1][TK_d]=B3;   trans[B1][TK_u]=Bu; 
@@ -1584,11 +1577,12 @@ numbers_gl::numbers_gl(const std::string &dec, const std::string &thou): numbers
 
 int numbers_gl::ComputeToken(int state, sentence::iterator &j, sentence &se)
 {
-  string form;
   int token;
   map<string,int>::iterator im;
  
-  form = util::lowercase(j->get_form());
+  // get word classification (computed once per sentence)
+  token_class &tc=classify(j);
+  const string &form=tc.lcform;
   
   token = TK_other;
   im = tok.find(form);
@@ -1602,8 +1596,8 @@ int numbers_gl::ComputeToken(int state, sentence::iterator &j, sentence &se)
 
   // Token not found in translation table, let's have a closer look.
   // check to see if it is a number
-  if (RE_number.Search(form)) token = TK_num;
-  else if (RE_code.Search(form)) token = TK_code;
+  if (tc.digit && check_regex(j,RX_NUM,RE_number)) token = TK_num;
+  else if (tc.digit && check_regex(j,RX_CODE,RE_code)) token = TK_code;
 
   TRACE(3,"Leaving state "+util::int2string(state)+" with token "+util::int2string(token)); 
   return (token);
@@ -2001,9 +1995,6 @@ numbers_it::numbers_it(const std::string &dec, const std::string &thou): numbers
 
   Final.insert(specialState);
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
   //state B1
   //handle sepcial state from automaton. This is the right place to do it. Inside out ComputeToken function we already compute the value of the token, since in italian, alike in german, numbers are compounded (embedded), one word, one number. 
   trans[B1][TK_special]=specialState;
@@ -2241,7 +2232,7 @@ int numbers_it::ComputeToken(int state, sentence::iterator &j, sentence &se)
 	// here is the trick. We will move the states in the automaton
 	// inside this function, then pass the last state to
 	// automaton::annotate function
-	newstate = trans[state][token];
+	newstate = next_state(state,token);
 
 	// let the child class perform any actions 
 	// for the new state (e.g. computing date value...)
@@ -2264,7 +2255,7 @@ int numbers_it::ComputeToken(int state, sentence::iterator &j, sentence &se)
       im = tok.find(fullForm);
       if (im!=tok.end()) {
 	token = (*im).second;
-	newstate = trans[state][token];
+	newstate = next_state(state,token);
 	StateActions(state, newstate, token, j);
 	didIRecognize=true;
       }
@@ -2275,7 +2266,7 @@ int numbers_it::ComputeToken(int state, sentence::iterator &j, sentence &se)
     
     if (im!=tok.end()) {	
       token = (*im).second;
-      newstate = trans[state][token];
+      newstate = next_state(state,token);
       StateActions(state, newstate, token, j);
       didIRecognize=true;
     }
@@ -2698,10 +2689,6 @@ numbers_en::numbers_en(const std::string &dec, const std::string &thou): numbers
   Final.insert(S5);  Final.insert(S6);  Final.insert(S7);  Final.insert(S8);
   Final.insert(COD);  
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-  
   // Initializing transitions table
   // State B1
   trans[B1][TK_u]=B2;     trans[B1][TK_a]=B2;     
@@ -2776,11 +2763,12 @@ numbers_en::numbers_en(const std::string &dec, const std::string &thou): numbers
 
 int numbers_en::ComputeToken(int state, sentence::iterator &j, sentence &se)
 {
-  string form;
   int token;
   map<string,int>::iterator im;
  
-  form = util::lowercase(j->get_form());
+  // get word classification (computed once per sentence)
+  token_class &tc=classify(j);
+  const string &form=tc.lcform;
 
   token = TK_other;
   im = tok.find(form);
@@ -2805,9 +2793,9 @@ int numbers_en::ComputeToken(int state, sentence::iterator &j, sentence &se)
   if (form.length()>2 && (sfx=="st" || sfx=="nd" || sfx=="rd" || sfx=="th") && RE_number.Search(pref) )
       token=TK_ord;
   // check to see if it is a number
-  else if (RE_number.Search(form)) token = TK_num;
+  else if (tc.digit && check_regex(j,RX_NUM,RE_number)) token = TK_num;
   // check to see if it is an alphanumeric code
-  else if (RE_code.Search(form)) token = TK_code;
+  else if (tc.digit && check_regex(j,RX_CODE,RE_code)) token = TK_code;
 
   TRACE(3,"Leaving state "+util::int2string(state)+" with token "+util::int2string(token)); 
   return (token);
@@ -29,6 +29,7 @@
 #include <fstream>
 #include <sstream>
 #include <set>
+#include <algorithm>
 
 #include "freeling/probabilities.h"
 #include "fries/util.h"
@@ -50,6 +51,9 @@ probabilities::probabilities(const std::string &Lang, const std::string &probFil
   string key,clas,frq,tag;
   map<string,double>::iterator k;
   map<string,double> temp_map;
+  // model as read from the file, before interning tags
+  map<string,double> single;
+  map<string,map<string,double> > classes, lexical, unk_suffs;
   double probab, sumUnk, numUnk, count;
   int reading;
 
@@ -94,7 +98,7 @@ probabilities::probabilities(const std::string &Lang, const std::string &probFil
       // reading Single tag frequencies
       sin>>key>>frq;
       probab=util::string2double(frq);
-      single_tags.insert(make_pair(key,probab));
+      single.insert(make_pair(key,probab));
     }
     else if (reading==2) {
       // reading tag class frequencies
@@ -104,7 +108,7 @@ probabilities::probabilities(const std::string &Lang, const std::string &probFil
 	probab=util::string2double(frq);
 	temp_map.insert(make_pair(tag,probab));
       }
-      class_tags.insert(make_pair(key,temp_map));
+      classes.insert(make_pair(key,temp_map));
     }
     else if (reading==3) {
       // reading form tag frequencies
@@ -114,7 +118,7 @@ probabilities::probabilities(const std::string &Lang, const std::string &probFil
 	probab=util::string2double(frq);
 	temp_map.insert(make_pair(tag,probab));
       }
-      lexical_tags.insert(make_pair(key,temp_map));
+      lexical.insert(make_pair(key,temp_map));
     }
     else if (reading==4) {
       // reading tags for unknown words
@@ -162,6 +166,82 @@ probabilities::probabilities(const std::string &Lang, const std::string &probFil
   for (k=unk_tags.begin(); k!=unk_tags.end(); k++)
     k->second = k->second / sumUnk;
 
+  // intern all short tags in the model. Ids are given in string order, 
+  // so sorted id sets follow the same order than class names.
+  set<string> alltags;
+  alltags.insert("NP");
+  map<string,map<string,double> >::const_iterator m;
+  map<string,double>::const_iterator t;
+  for (t=single.begin(); t!=single.end(); t++) alltags.insert(t->first);
+  for (m=classes.begin(); m!=classes.end(); m++) {
+    vector<string> ct=util::string2vector(m->first,"-");
+    alltags.insert(ct.begin(),ct.end());
+    for (t=m->second.begin(); t!=m->second.end(); t++) alltags.insert(t->first);
+  }
+  for (m=lexical.begin(); m!=lexical.end(); m++) 
+    for (t=m->second.begin(); t!=m->second.end(); t++) alltags.insert(t->first);
+
+  int n=0;
+  for (set<string>::const_iterator x=alltags.begin(); x!=alltags.end(); x++) 
+    tag_ids.insert(make_pair(*x,n++));
+  NP_id = tag_ids.find("NP")->second;
+
+  // store distributions in flat arrays indexed by tag id
+  single_tags.assign(n,0.0);
+  for (t=single.begin(); t!=single.end(); t++) 
+    single_tags[tag_ids.find(t->first)->second] = t->second;
+
+  for (m=classes.begin(); m!=classes.end(); m++) {
+    vector<string> ct=util::string2vector(m->first,"-");
+    vector<int> cl;
+    for (vector<string>::const_iterator x=ct.begin(); x!=ct.end(); x++) 
+      cl.push_back(tag_ids.find(*x)->second);
+    sort(cl.begin(),cl.end());
+    if (class_ids.find(cl)==class_ids.end())
+      class_ids.insert(make_pair(cl,class_tags.add(m->second,tag_ids)));
+  }
+
+  for (m=lexical.begin(); m!=lexical.end(); m++) 
+    form_ids.insert(make_pair(m->first,lexical_tags.add(m->second,tag_ids)));
+
+  // position of each unknown word tag, and its short version
+  map<string,int> unk_ids;
+  for (t=unk_tags.begin(); t!=unk_tags.end(); t++) {
+    unk_ids.insert(make_pair(t->first,(int)unk_short.size()));
+    unk_short.push_back(analysis("",t->first).get_short_parole(Language));
+  }
+
+  // build suffix trie, inserting reversed suffixes
+  vector<map<char,int> > children(1);
+  vector<const map<string,double>*> suffdata(1,(const map<string,double>*)NULL);
+  for (m=unk_suffs.begin(); m!=unk_suffs.end(); m++) {
+    int node=0;
+    for (int i=m->first.size()-1; i>=0; i--) {
+      map<char,int>::const_iterator c=children[node].find(m->first[i]);
+      if (c!=children[node].end()) node=c->second;
+      else {
+	children[node].insert(make_pair(m->first[i],(int)children.size()));
+	node=children.size();
+	children.push_back(map<char,int>());
+	suffdata.push_back(NULL);
+      }
+    }
+    suffdata[node]=&(m->second);
+  }
+
+  // store it in flat arrays
+  map<string,double> none;
+  suff_offs.push_back(0);
+  for (size_t node=0; node<children.size(); node++) {
+    for (map<char,int>::const_iterator c=children[node].begin(); c!=children[node].end(); c++) {
+      suff_chars.push_back(c->first);
+      suff_nodes.push_back(c->second);
+    }
+    suff_offs.push_back(suff_chars.size());
+    suff_found.push_back(suffdata[node]!=NULL);
+    suff_probs.add(suffdata[node]!=NULL ? *suffdata[node] : none, unk_ids);
+  }
+
   TRACE(3,"analyzer succesfully created");
 }
 
@@ -343,116 +423,141 @@ void probabilities::smoothing(word &w) {
   // form has analysis. begin probability back-off
   TRACE(2,"Form with analysis. Smoothing probabilites.");
 
-  // count occurrences of short tags 
-  map<string,double> tags_short;
+  // get id of the short tag of each analysis (-1 if not in the model)
+  vector<int> ids;
+  ids.reserve(na);
+  bool unknown=false;
   for (word::iterator li=w.begin(); li!=w.end(); li++) {
-    map<string,double>::iterator p=tags_short.find(li->get_short_parole(Language));
-    if (p==tags_short.end())
-       tags_short.insert(make_pair(li->get_short_parole(Language),1.0));
-    else 
-      p->second++;
+    map<string,int>::const_iterator t=tag_ids.find(li->get_short_parole(Language));
+    if (t!=tag_ids.end()) ids.push_back(t->second);
+    else { ids.push_back(-1); unknown=true; }
   }
   
-  // build word ambiguity class with and without NP tags
-  string c=""; string cNP="";
-  for (map<string,double>::iterator x=tags_short.begin(); x!=tags_short.end(); x++) {
-    cNP += "-"+x->first;
-    if ( x->first != "NP" ) c += "-"+x->first;
-  }
+  // build word ambiguity class (sorted tag ids) with and without NP tags
+  vector<int> cNP(ids);
+  sort(cNP.begin(),cNP.end());
+  cNP.erase(unique(cNP.begin(),cNP.end()),cNP.end());
+  vector<int> c;
+  for (vector<int>::const_iterator x=cNP.begin(); x!=cNP.end(); x++)
+    if (*x!=NP_id) c.push_back(*x);
 
   bool trysec=false;
-
-  if (c==cNP) { // no NP tags, only one class
-    cNP=cNP.substr(1);   
-    TRACE(3,"Ambiguity class ("+cNP+")");
-  }
-  else {
+  if (c.size()!=cNP.size()) {
     // there is one NP, check both classes
-    cNP=cNP.substr(1);
-    TRACE(3,"Ambiguity class ("+cNP+")");
-
-    if (not c.empty()) {
-      c=c.substr(1);
-      TRACE(3,"Secondary ambiguity class ("+c+")");
-      trysec=true;   // try secondary class if primary fails.
-    }
+    if (not c.empty()) trysec=true;   // try secondary class if primary fails.
     else 
       WARNING("Empty ambiguity class for word '"+w.get_form()+"'. Duplicate NP analysis??");
-
   }  
 
-  map<string,map<string,double> >::iterator it;
-  map<string,double> *temp_map=NULL;
-  string form=util::lowercase(w.get_form());
-
-  it = lexical_tags.find(form);
-  if (it!=lexical_tags.end()) {
+  // classes with tags unknown to the model can not be found.
+  const distributions *dist=NULL;
+  int d=-1;
+  map<string,int>::const_iterator f=form_ids.find(util::lowercase(w.get_form()));
+  if (f!=form_ids.end()) {
     // word found in lexical probabilities list. Use them straightforwardly.
-    TRACE(2,"Form '"+form+"' contained in the lexical_tags map");
-    temp_map= &(it->second);    
+    TRACE(2,"Form contained in the lexical_tags map");
+    dist=&lexical_tags; d=f->second;
   }  
-  else {
-    it = class_tags.find(cNP);
-    if (it!=class_tags.end()){
+  else if (not unknown) {
+    map<vector<int>,int>::const_iterator k=class_ids.find(cNP);
+    if (k!=class_ids.end()) {
       // Word not in lexical probs list. Back off to ambiguity class
-      TRACE(2,"Ambiguity class '"+cNP+"' found in class_tags map");
-      temp_map= &(it->second);          
+      TRACE(2,"Ambiguity class found in class_tags map");
+      dist=&class_tags; d=k->second;
     }
     else if (trysec) {
-      it = class_tags.find(c);
-      if (it !=class_tags.end()){
+      k=class_ids.find(c);
+      if (k!=class_ids.end()) {
 	// Ambiguity class not found. Try secondary class, if any.
-	TRACE(2,"Secondary ambiguity class '"+c+"' found in class_tags map");
-	temp_map= &(it->second);          
+	TRACE(2,"Secondary ambiguity class found in class_tags map");
+	dist=&class_tags; d=k->second;
       }
     }
   }
 
-  if (temp_map==NULL) temp_map = &single_tags;
-
+  // probability of each tag in the class (sorted, so the sum is 
+  // accumulated in the same order than the class name).
+  vector<double> pc(cNP.size());
   double sum=0;
-  for (map<string,double>::iterator x=tags_short.begin(); x!=tags_short.end(); x++) 
-    sum += (*temp_map)[x->first] * x->second;
-  
-  for (word::iterator li=w.begin(); li!=w.end(); li++)
-    li->set_prob(((*temp_map)[li->get_short_parole(Language)]+(1/(double)na))/(sum+1));
+  for (size_t i=0; i<cNP.size(); i++) {
+    if (cNP[i]<0) pc[i]=0;
+    else pc[i] = (dist!=NULL ? dist->get(d,cNP[i]) : single_tags[cNP[i]]);
+    sum += pc[i] * (double) count(ids.begin(),ids.end(),cNP[i]);
+  }
   
- 
+  int i=0;
+  for (word::iterator li=w.begin(); li!=w.end(); li++,i++) {
+    double p = pc[lower_bound(cNP.begin(),cNP.end(),ids[i])-cNP.begin()];
+    li->set_prob((p+(1/(double)na))/(sum+1));
+  }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+/// Create an empty list of distributions
+/////////////////////////////////////////////////////////////////////////////
+
+probabilities::distributions::distributions() {
+  offs.push_back(0);
 }
 
+/////////////////////////////////////////////////////////////////////////////
+/// Add a distribution, return its index. Tags without id are skipped.
+/////////////////////////////////////////////////////////////////////////////
+
+int probabilities::distributions::add(const map<string,double> &dist, const map<string,int> &ids) {
 
+  for (map<string,double>::const_iterator t=dist.begin(); t!=dist.end(); t++) {
+    map<string,int>::const_iterator id=ids.find(t->first);
+    if (id==ids.end()) continue;
+    tags.push_back(id->second);
+    probs.push_back(t->second);
+  }
+  offs.push_back(tags.size());
+  return offs.size()-2;
+}
 
 /////////////////////////////////////////////////////////////////////////////
-/// Compute probability of a tag given a word suffix.
+/// Probability of given tag in distribution d (0 if not there). 
+/// Distributions are short, so they are just scanned.
 /////////////////////////////////////////////////////////////////////////////
 
-double probabilities::compute_probability(const std::string &tag, double prob, const std::string &s) {
-  map<string,map<string,double> >::const_iterator is;
-  map<string,double>::const_iterator it;
-  double x,pt;
+double probabilities::distributions::get(int d, int tag) const {
+  for (int k=offs[d]; k<offs[d+1]; k++)
+    if (tags[k]==tag) return probs[k];
+  return 0;
+}
+
 
-  x=prob;  
-  int spos=s.size();
-  bool found=true;
-  while (spos>0 && found) {
 
-    spos--;
+/////////////////////////////////////////////////////////////////////////////
+/// Compute probability of each unknown word tag given a word suffix.
+/// x contains the prior probabilities (in unk_tags order), and is 
+/// updated with each suffix of the word found in the model, from the 
+/// shortest to the longest, walking down the suffix trie.
+/////////////////////////////////////////////////////////////////////////////
 
-    is = unk_suffs.find(s.substr(spos));
-    found = (is != unk_suffs.end());
+void probabilities::compute_probabilities(const std::string &s, vector<double> &x) const {
 
-    if (found) {
-      // search tag in suffix probability list. It should be there.
-      it = (is->second).find(tag);
-      if (it != (is->second).end()) pt = it->second;
-      else pt = 0;
+  vector<double> pt(x.size(),0.0);
+  int node=0;
+  for (int spos=s.size()-1; spos>=0; spos--) {
 
-      x=(pt+theeta*x)/(1+theeta);
-    }
-  }
+    vector<char>::const_iterator b=suff_chars.begin()+suff_offs[node];
+    vector<char>::const_iterator e=suff_chars.begin()+suff_offs[node+1];
+    vector<char>::const_iterator c=lower_bound(b,e,s[spos]);
+    if (c==e || *c!=s[spos]) break;
 
-  return x;
+    node=suff_nodes[c-suff_chars.begin()];
+    if (!suff_found[node]) break;
 
+    // tags not in suffix probability list get 0.
+    int k0=suff_probs.offs[node], k1=suff_probs.offs[node+1];
+    for (int k=k0; k<k1; k++) pt[suff_probs.tags[k]]=suff_probs.probs[k];
+    for (size_t t=0; t<x.size(); t++)
+      x[t]=(pt[t]+theeta*x[t])/(1+theeta);
+    for (int k=k0; k<k1; k++) pt[suff_probs.tags[k]]=0;
+  }
 }
 
 
@@ -476,19 +581,27 @@ double probabilities::guesser(word &w, double mass) {
   for (word::iterator li=w.begin(); li!=w.end(); li++)
     stags.insert(li->get_short_parole(Language));
 
+  // compute probability of all possible tags with one walk over the suffixes
+  vector<double> pr;
+  pr.reserve(unk_tags.size());
+  for (map<string,double>::iterator t=unk_tags.begin(); t!=unk_tags.end(); t++) 
+    pr.push_back(t->second);
+  compute_probabilities(form,pr);
+
   // to store analysis under threshold, just in case
   list<analysis> la;
-  // for each possible tag, compute probability
-  for (map<string,double>::iterator t=unk_tags.begin(); t!=unk_tags.end(); t++) {
+  // for each possible tag, check probability
+  int i=0;
+  for (map<string,double>::iterator t=unk_tags.begin(); t!=unk_tags.end(); t++,i++) {
     
     // See if it was already there, set by some other module
-    analysis a(form,t->first);
-    bool hasit = (stags.find(a.get_short_parole(Language))!=stags.end());
+    bool hasit = (stags.find(unk_short[i])!=stags.end());
     
     // if we don't have it, consider including it in the list
     if (!hasit) {
       
-      double p = compute_probability(t->first,t->second,form);
+      analysis a(form,t->first);
+      double p = pr[i];
       a.set_prob(p);
       
       TRACE(2,"   tag:"+t->first+" ("+(hasit?"had it":"new")+")  pr="+util::double2string(p)+" "+util::double2string(t->second));
@@ -81,10 +81,6 @@ quantities_default::quantities_default(const std::string &CurrFile): quantities_
   // Initialize Final state set
   Final.insert(C); 
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-  
   // State A
   trans[A][TK_number]=B;
   // State B
@@ -341,10 +337,6 @@ quantities_es::quantities_es(const std::string &QuantFile): quantities_module()
   // Initialize Final state set 
   Final.insert(C);  Final.insert(G); 
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-  
   // State A
   trans[A][TK_number]=B;
   // State B
@@ -719,10 +711,6 @@ quantities_ca::quantities_ca(const std::string &QuantFile): quantities_module()
   // Initialize Final state set 
   Final.insert(C);  Final.insert(G); 
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-  
   // State A
   trans[A][TK_number]=B;
   // State B
@@ -1097,10 +1085,6 @@ quantities_gl::quantities_gl(const std::string &QuantFile): quantities_module()
   // Initialize Final state set 
   Final.insert(C);  Final.insert(G); 
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-  
   // State A
   trans[A][TK_number]=B;
   // State B
@@ -1477,10 +1461,6 @@ quantities_en::quantities_en(const std::string &QuantFile): quantities_module()
   // Initialize Final state set 
   Final.insert(C);  Final.insert(G); 
 
-  // Initialize transitions table. By default, stop state
-  int s,t;
-  for(s=0;s<MAX_STATES;s++) for(t=0;t<MAX_TOKENS;t++) trans[s][t]=STOP;
-  
   // State A
   trans[A][TK_number]=B;
   // State B
@@ -82,26 +82,19 @@ void senses::analyze(std::list<sentence> &ls) {
 	else {
 	  // senses found for that lemma
           if (duplicate) {
-            list<string> ss;
-	    list<string>::iterator s=lsen.begin(); 
             double newpr= a->get_prob()/lsen.size();
-          
+	    // single-sense list reused for every copy, only its sense is overwritten
+	    list<pair<string, double> > ss(1, make_pair(string(""), 0.0));
+
+	    list<string>::iterator s;
 	    for (s=lsen.begin(); s!=lsen.end(); s++) {
-	      // create a copy of the analysis for each sense
-	      analysis *newan = new analysis(*a);
+	      // create a copy of the analysis for each sense, directly in the new list
+	      newla.push_back(*a);
+	      analysis &newan = newla.back();
 	      // add current sense to new analysis, overwriting.
-              ss.clear(); ss.push_back(*s);  
-
- 	      list<string>::iterator lsi;
-	      list<pair<string, double> > lsen_noranks;
-	      for (lsi = ss.begin(); lsi != ss.end(); lsi++) {
-	    	  lsen_noranks.push_back(make_pair(*lsi, 0.0));
-	      }
-              newan->set_senses(lsen_noranks); 
-
-	      newan->set_prob(newpr);
-	      // add new analysis to the new list
-	      newla.push_back(*newan);
+	      ss.front().first = *s;
+              newan.set_senses(ss); 
+	      newan.set_prob(newpr);
 
 	      TRACE(3, "  Duplicating analysis for sense "+(*s));
 	    }
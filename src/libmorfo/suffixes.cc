@@ -58,7 +58,9 @@ affixes::affixes(const std::string &Lang, const std::string &sufFile): accen(Lan
   }
   
   int kind= -1;
-  Longest[SUF]=0;  Longest[PREF]=0;    
+  // create trie roots
+  trie[SUF].push_back(trie_node());
+  trie[PREF].push_back(trie_node());
   // load suffix rules
   while (getline(fabr, line)) {
     // skip comentaries and empty lines       
@@ -83,11 +85,33 @@ affixes::affixes(const std::string &Lang, const std::string &sufFile): accen(Lan
 	suf.nomore=nomore; suf.lema=lema; suf.always=always; 
 	suf.retok=retok;
 	if (suf.retok=="-") suf.retok.clear();
-	// Insert rule in appropriate affix multimaps.
-	affix[kind].insert(make_pair(key,suf));
-	if (suf.always) affix_always[kind].insert(make_pair(key,suf));	
-	ExistingLength[kind].insert(key.size());
-	if (key.size()>Longest[kind]) Longest[kind]=key.size();
+	// split list of terminations/beginnings once for all
+	string::size_type p=0, pe=term.find_first_of("|");
+	while (pe!=string::npos) {
+	  suf.terms.push_back(term.substr(p,pe-p));
+	  p=pe+1;
+	  pe=term.find_first_of("|",p);
+	}
+	suf.terms.push_back(term.substr(p));
+	for (vector<string>::iterator t=suf.terms.begin(); t!=suf.terms.end(); t++)
+	  if (*t=="*") t->clear(); // null termination
+
+	// store rule, and insert it in the trie node for its affix (reversed for suffixes)
+	int r=rules[kind].size();
+	rules[kind].push_back(suf);
+	int node=0;
+	for (string::size_type i=0; i<key.size(); i++) {
+	  char c = (kind==SUF ? key[key.size()-1-i] : key[i]);
+	  int n=trie_child(kind,node,c);
+	  if (n<0) {
+	    n=trie[kind].size();
+	    trie[kind][node].next.insert(make_pair(c,n));
+	    trie[kind].push_back(trie_node());
+	  }
+	  node=n;
+	}
+	trie[kind][node].all.push_back(r);
+	if (suf.always) trie[kind][node].always.push_back(r);
       }
     }
   }
@@ -110,75 +134,97 @@ void affixes::look_for_affixes(word &w, dictionary &dic) {
     // word with analysys already. Check only "always-checkable" affixes
     TRACE(2,"=== Known word '"+w.get_form()+"', with "+util::int2string(w.get_n_analysis())+" analysis. Looking only for 'always' affixes");
     TRACE(3," --- Cheking SUF ---");
-    look_for_affixes_in_list(SUF,affix_always[SUF],w,dic);
+    look_for_affixes_in_list(SUF,true,w,dic);
     TRACE(3," --- Cheking PREF ---");
-    look_for_affixes_in_list(PREF,affix_always[PREF],w,dic);
+    look_for_affixes_in_list(PREF,true,w,dic);
     TRACE(3," --- Cheking PREF+SUF ---");
-    look_for_combined_affixes(affix_always[SUF],affix_always[PREF],w,dic);
+    look_for_combined_affixes(true,w,dic);
   }
   else {
     // word not in dictionary. Check all affixes
     TRACE(2,"===Unknown word '"+w.get_form()+"'. Looking for any affix");
     TRACE(3," --- Cheking SUF ---");
-    look_for_affixes_in_list(SUF,affix[SUF],w,dic);
+    look_for_affixes_in_list(SUF,false,w,dic);
     TRACE(3," --- Cheking PREF ---");
-    look_for_affixes_in_list(PREF,affix[PREF],w,dic);
+    look_for_affixes_in_list(PREF,false,w,dic);
     TRACE(3," --- Cheking PREF+SUF ---");
-    look_for_combined_affixes(affix[SUF],affix[PREF],w,dic);
+    look_for_combined_affixes(false,w,dic);
+  }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Follow char c from given node of the trie for given affix kind.
+/// Return the child node, or -1 if there is none.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+int affixes::trie_child(int kind, int node, char c) const
+{
+  map<char,int>::const_iterator n=trie[kind][node].next.find(c);
+  if (n==trie[kind][node].next.end()) return -1;
+  return n->second;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Walk the trie for given affix kind from the corresponding end of the word,
+/// and collect (affix length, trie node) for all affixes having rules. 
+/// Affixes are found in increasing length, and at least one char is left for the root.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void affixes::find_affixes(int kind, bool always, const string &lws, vector<pair<unsigned int,int> > &found) const
+{
+  unsigned int i, len=lws.length();
+  int node=0;
+
+  found.clear();
+  for (i=1; i<len; i++) {
+    node = trie_child(kind, node, (kind==SUF ? lws[len-i] : lws[i-1]));
+    if (node<0) break;  // no longer affixes
+
+    const trie_node &n=trie[kind][node];
+    if (not (always ? n.always : n.all).empty()) 
+      found.push_back(make_pair(i,node));
   }
 }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Look for suffixes of the word w, using the given multimap.
+// Look for suffixes of the word w, using all rules or only "always" rules.
 // The word is annotated with new analysis, if any.
 //////////////////////////////////////////////////////////////////////////////////////////
 
-void affixes::look_for_affixes_in_list(int kind, std::multimap<std::string,sufrule> &suff, word &w, dictionary &dic) const
+void affixes::look_for_affixes_in_list(int kind, bool always, word &w, dictionary &dic)
 {
-  typedef multimap<string,sufrule>::iterator T1;
-  T1 sufit;
-  pair<T1,T1> rules;
+  vector<pair<unsigned int,int> > found;
   set<string> candidates;
   string lws,form_term,form_root;
-  unsigned int i,j, len;
+  unsigned int i,len;
 
   lws=w.get_form();
   len=lws.length();
-  for (i=1; i<=Longest[kind] && i<len; i++) {
-    // advance backwards in form
-    j=len-i;
+  find_affixes(kind,always,lws,found);
 
-    // check whether there are any affixes of that size
-    if (ExistingLength[kind].find(i)==ExistingLength[kind].end()) {
-      TRACE(4,"No affixes of size "+util::int2string(i));
-    }
-    else {
-      // get the termination/beggining
-      if (kind==SUF) form_term = lws.substr(j);
-      else if (kind==PREF) form_term = lws.substr(0,i);
-
-      // get all rules for that suffix
-      rules=suff.equal_range(form_term);
-      if (rules.first==suff.end() || rules.first->first!=form_term) {
-	TRACE(3,"No rules for affix "+form_term+" (size "+util::int2string(i)+")");
-      }
-      else {
-	TRACE(3,"Found "+util::int2string(suff.count(form_term))+" rules for affix "+form_term+" (size "+util::int2string(i)+")");
-	for (sufit=rules.first; sufit!=rules.second; sufit++) {
-	  // get the stem, after removing the affix
-	  if (kind==SUF) form_root = lws.substr(0,j);
-	  else if (kind==PREF) form_root = lws.substr(i);
-	  TRACE(3,"Trying rule ["+form_term+" "+sufit->second.term+" "+sufit->second.cond.expression+" "+sufit->second.output+"] on root "+form_root);
+  for (vector<pair<unsigned int,int> >::iterator f=found.begin(); f!=found.end(); f++) {
+    i=f->first;
+    // get the termination/beggining, and the stem after removing it
+    if (kind==SUF) { form_term = lws.substr(len-i); form_root = lws.substr(0,len-i); }
+    else if (kind==PREF) { form_term = lws.substr(0,i); form_root = lws.substr(i); }
+
+    // get all rules for that affix
+    const vector<int> &rl = (always ? trie[kind][f->second].always : trie[kind][f->second].all);
+    TRACE(3,"Found "+util::int2string(rl.size())+" rules for affix "+form_term+" (size "+util::int2string(i)+")");
+
+    for (vector<int>::const_iterator r=rl.begin(); r!=rl.end(); r++) {
+      sufrule &suf=rules[kind][*r];
+      TRACE(3,"Trying rule ["+form_term+" "+suf.term+" "+suf.cond.expression+" "+suf.output+"] on root "+form_root);
 	  
-	  // complete all possible roots, using terminations/begginings provided in suffix rule
-	  candidates = GenerateRoots(kind, sufit->second, form_root);
-	  // fix accentuation patterns of obtained roots
-	  accen.fix_accentuation(candidates, sufit->second);
-	  // enrich word analysis list with dictionary entries for valid roots
-	  SearchRootsList(candidates, form_term, sufit->second, w, dic);
-	}
-      }
+      // complete all possible roots, using terminations/begginings provided in suffix rule
+      GenerateRoots(kind, suf, form_root, candidates);
+      // fix accentuation patterns of obtained roots
+      accen.fix_accentuation(candidates, suf);
+      // enrich word analysis list with dictionary entries for valid roots
+      SearchRootsList(candidates, form_term, suf, w, dic);
     }
   }
 }
@@ -189,70 +235,58 @@ void affixes::look_for_affixes_in_list(int kind, std::multimap<std::string,sufru
 // The word is annotated with new analysis, if any.
 //////////////////////////////////////////////////////////////////////////////////////////
 
-void affixes::look_for_combined_affixes(std::multimap<std::string,sufrule> &suff, std::multimap<std::string,sufrule> &pref, word &w, dictionary &dic) const
+void affixes::look_for_combined_affixes(bool always, word &w, dictionary &dic)
 {
-  typedef multimap<string,sufrule>::iterator T1;
-  T1 sufit,prefit;
-  pair<T1,T1> rules_S,rules_P;
+  vector<pair<unsigned int,int> > found_S, found_P;
+  vector<pair<unsigned int,int> >::iterator fs,fp;
   set<string> candidates,cand1,cand2;
   string lws,form_suf,form_pref,form_root;
   unsigned int i,j,len;
 
   lws=w.get_form();
   len=lws.length();
-  for (i=1; i<=Longest[SUF] && i<len; i++) {
-    // check whether there are any suffixes of that size. 
-    if (ExistingLength[SUF].find(i)==ExistingLength[SUF].end()) {
-      TRACE(4,"No suffixes of size "+util::int2string(i));
-      continue; // Skip to next size if none found
-    }
+
+  // find all suffixes and prefixes with rules, walking the word once from each end.
+  find_affixes(SUF,always,lws,found_S);
+  if (found_S.empty()) return;
+  find_affixes(PREF,always,lws,found_P);
+
+  for (fs=found_S.begin(); fs!=found_S.end(); fs++) {
+    i=fs->first;
+    const vector<int> &rules_S = (always ? trie[SUF][fs->second].always : trie[SUF][fs->second].all);
  
     // check prefixes, only to len-i, since i+j>=len leaves no space for a root.
-    for (j=1; j<=Longest[PREF] && j<len-i; j++) {  
-      // check whether there are any suffixes of that size. Skip to next if none found
-      if (ExistingLength[PREF].find(j)==ExistingLength[PREF].end()) {
-	TRACE(4,"No prefixes of size "+util::int2string(j));
-	continue; // Skip to next size if none found
-      }
+    for (fp=found_P.begin(); fp!=found_P.end() && fp->first<len-i; fp++) {
+      j=fp->first;
+      const vector<int> &rules_P = (always ? trie[PREF][fp->second].always : trie[PREF][fp->second].all);
       
-      // get sufix and prefix of current lengths
+      // get sufix, prefix, and the stem after removing them
       form_suf = lws.substr(len-i);
       form_pref = lws.substr(0,j);
-      // get all rules for those affixes
-      rules_S = suff.equal_range(form_suf);
-      if (rules_S.first==suff.end() || rules_S.first->first!=form_suf) {
-	TRACE(3,"No rules for suffix "+form_suf+" (size "+util::int2string(i)+")");
-	continue; // Skip to next size if no rules found
-      }
-      rules_P = pref.equal_range(form_pref);
-      if (rules_P.first==pref.end() || rules_P.first->first!=form_pref) {
-	TRACE(3,"No rules for prefix "+form_pref+" (size "+util::int2string(j)+")");
-	continue; // Skip to next size if no rules found
-      }
-
-      // get the stem, after removing the suffix and prefix
-      form_root = lws.substr(0,len-i).substr(j);
+      form_root = lws.substr(j,len-i-j);
       TRACE(3,"Trying a decomposition: "+form_pref+"+"+form_root+"+"+form_suf);
 
       // if we reach here, there are rules for a sufix and a prefix of the word.      
-      TRACE(3,"Found "+util::int2string(suff.count(form_suf))+" rules for suffix "+form_suf+" (size "+util::int2string(i)+")");
-      TRACE(3,"Found "+util::int2string(pref.count(form_pref))+" rules for prefix "+form_pref+" (size "+util::int2string(j)+")");
+      TRACE(3,"Found "+util::int2string(rules_S.size())+" rules for suffix "+form_suf+" (size "+util::int2string(i)+")");
+      TRACE(3,"Found "+util::int2string(rules_P.size())+" rules for prefix "+form_pref+" (size "+util::int2string(j)+")");
       
       bool wfid=w.found_in_dict();
 
-      for (sufit=rules_S.first; sufit!=rules_S.second; sufit++) {
-	for (prefit=rules_P.first; prefit!=rules_P.second; prefit++) {
+      for (vector<int>::const_iterator rs=rules_S.begin(); rs!=rules_S.end(); rs++) {
+	sufrule &suf=rules[SUF][*rs];
+	for (vector<int>::const_iterator rp=rules_P.begin(); rp!=rules_P.end(); rp++) {
+	  sufrule &pref=rules[PREF][*rp];
 	  
 	  candidates.clear();
 	  // cand1: all possible completions with suffix rule
-	  cand1 = GenerateRoots(SUF, sufit->second, form_root);
+	  GenerateRoots(SUF, suf, form_root, cand1);
 	  // fix accentuation patterns of obtained roots
-	  accen.fix_accentuation(cand1, sufit->second);
+	  accen.fix_accentuation(cand1, suf);
           for (set<string>::iterator s=cand1.begin(); s!=cand1.end(); s++) {
 	    // cand2: for each cand1, generate all possible completions with pref rule 
-	    cand2 = GenerateRoots(PREF, prefit->second, (*s));
+	    GenerateRoots(PREF, pref, (*s), cand2);
 	    // fix accentuation patterns of obtained roots
-	    accen.fix_accentuation(cand2, prefit->second);
+	    accen.fix_accentuation(cand2, pref);
 	    // accumulate cand2 to candidate list.
 	    candidates.insert(cand2.begin(),cand2.end());
 	  }
@@ -260,13 +294,13 @@ void affixes::look_for_combined_affixes(std::multimap<std::string,sufrule> &suff
 	  // enrich word analysis list with dictionary entries for valid roots
 	  word waux=w;
 	  // apply prefix rules and generate analysis in waux.
-	  SearchRootsList(candidates, form_pref, prefit->second, waux, dic);
+	  SearchRootsList(candidates, form_pref, pref, waux, dic);
 	  // use analysis in waux as base to apply suffix rule
           for (set<string>::iterator s=candidates.begin(); s!=candidates.end(); s++) 
-	    ApplyRule(form_pref+(*s), waux, form_suf, sufit->second, w, dic);
+	    ApplyRule(form_pref+(*s), waux, form_suf, suf, w, dic);
 
 	  // unless both rules stated nomore, leave everything as it was
-	  if (not (sufit->second.nomore and prefit->second.nomore))
+	  if (not (suf.nomore and pref.nomore))
 	    w.set_found_in_dict(wfid);  
 	}
       }
@@ -277,50 +311,26 @@ void affixes::look_for_combined_affixes(std::multimap<std::string,sufrule> &suff
 
 //////////////////////////////////////////////////////////////////////////////////////////
 /// Generate all possible forms expanding root rt with all possible terminations
-/// according to the given suffix rule.
+/// according to the given suffix rule. Results are left in cand (previous
+/// contents are discarded).
 //////////////////////////////////////////////////////////////////////////////////////////
 
-set<string> affixes::GenerateRoots(int kind, const sufrule &suf, const std::string &rt) const
+void affixes::GenerateRoots(int kind, const sufrule &suf, const std::string &rt, set<string> &cand) const
 {
-  set<string> cand;
-  string term,r;
-  size_t pe;
-
   cand.clear();
-  term=suf.term;
-  TRACE(3,"possible terminations/begginings: "+term);
+  TRACE(3,"possible terminations/begginings: "+suf.term);
 
   // fill the set of completed roots
-  pe=term.find_first_of("|");
-  while (pe!=string::npos) {
-    r=term.substr(0,pe);
-    if (r=="*")  r=""; // null termination
-
+  for (vector<string>::const_iterator t=suf.terms.begin(); t!=suf.terms.end(); t++) {
     if (kind==SUF) {
-      TRACE(3,"Adding to t_roots the element: "+rt+r);
-      cand.insert(rt+r);
+      TRACE(3,"Adding to t_roots the element: "+rt+(*t));
+      cand.insert(rt+(*t));
     }
     else if (kind==PREF) {
-      TRACE(3,"Adding to t_roots the element: "+r+rt);
-      cand.insert(r+rt);
+      TRACE(3,"Adding to t_roots the element: "+(*t)+rt);
+      cand.insert((*t)+rt);
     }
-
-    term=term.substr(pe+1);
-    pe=term.find_first_of("|");
-  }
-
-  // adding the last termination/beggining in the list
-  if (term=="*") term="";
-  if (kind==SUF) {
-    TRACE(3,"Adding to t_roots the element: "+rt+term);
-    cand.insert(rt+term);
   }
-  else if (kind==PREF) {
-    TRACE(3,"Adding to t_roots the element: "+term+rt);
-    cand.insert(term+rt);
-  }
-
-  return(cand);
 }
 
 
@@ -346,9 +356,9 @@ void affixes::SearchRootsList(set<string> &roots, const string &aff, sufrule &su
 
     r=remain.begin();
 
-    // look into the dictionary for that root
+    // look into the dictionary for that root (if the filter says it may be there)
     la.clear();
-    dic.search_form(*r,la);
+    if (dic.may_contain_form(*r)) dic.search_form(*r,la);
 
     // if found, we must construct the analysis for the suffix
     if (la.empty()) {
@@ -73,10 +73,16 @@ maco *morfo;
 nec *neclass;
 senses *sens;
 disambiguator *dsb;
+// rank vectors and window context of the disambiguator
+disambiguator::workspace *dsbws;
 POS_tagger *tagger;
 chart_parser *parser;
 dependency_parser *dep;
 coref *corfc;
+// coreference status and paragraphs waiting for it to be final
+coref::state corfst;
+list<paragraph> pending;
+list<int> pendcand;
 // read configuration file and command-line options
 config *cfg;
 // performance statistics
@@ -116,7 +122,7 @@ void AnalyzeSentences(list<sentence> &ls) {
   if (cfg->InputFormat < TAGGED && cfg->OutputFormat >= TAGGED) 
     tagger->analyze (ls);
   if (cfg->OutputFormat >= TAGGED and (cfg->SENSE_SenseAnnotation == UKB)) 
-    dsb->analyze (ls);
+    dsb->analyze (ls, *dsbws);
   if (cfg->OutputFormat >= TAGGED and cfg->NEC_NEClassification) 
     neclass->analyze (ls);
   if (cfg->OutputFormat >= SHALLOW)
@@ -349,6 +355,7 @@ void cleanup() {
   delete tagger;
   delete neclass;
   delete sens;
+  delete dsbws;
   delete dsb;
   delete parser;
   delete dep;
@@ -532,8 +539,10 @@ void CreateAnalyzers(char **argv) {
       and (cfg->SENSE_SenseAnnotation == MFS or cfg->SENSE_SenseAnnotation == ALL))
     sens = new senses (cfg->SENSE_SenseFile, cfg->SENSE_DuplicateAnalysis);
   else if (cfg->InputFormat < SENSE and cfg->OutputFormat >= TAGGED
-      and (cfg->SENSE_SenseAnnotation == UKB))      
-    dsb = new disambiguator (cfg->UKB_BinFile, cfg->UKB_DictFile, cfg->UKB_Epsilon, cfg->UKB_MaxIter);
+      and (cfg->SENSE_SenseAnnotation == UKB)) {
+    dsb = new disambiguator (cfg->UKB_BinFile, cfg->UKB_DictFile, cfg->UKB_Epsilon, cfg->UKB_MaxIter, cfg->UKB_Threads, cfg->UKB_PushEpsilon, cfg->UKB_WarmStart, cfg->UKB_StableIter, cfg->UKB_Window);
+    dsbws = new disambiguator::workspace();
+  }
 
   // tagger requested, see which method
   if (cfg->InputFormat < TAGGED and cfg->OutputFormat >= TAGGED) {
@@ -574,6 +583,39 @@ void CreateAnalyzers(char **argv) {
 
 
 
+//---------------------------------------------
+// Analyze a complete paragraph and solve its coreferences with
+// previous ones. Output paragraphs whose noun phrases are too far
+// from any later one to corefer with it (or all, if flush is set)
+//---------------------------------------------
+void AnalyzeParagraphCoref(paragraph &par, document &doc, bool flush) {
+  if (not par.empty()) {
+    morfo->analyze(par);
+    tagger->analyze(par);
+    neclass->analyze(par);
+    parser->analyze(par);
+
+    // solve coreference with previous paragraphs
+    corfc->analyze(par, doc, corfst);
+
+    pending.push_back(paragraph());
+    pending.back().swap(par);
+    pendcand.push_back(corfst.candidates());
+  }
+
+  while (not pending.empty() and 
+         (flush or corfst.candidates() >= pendcand.front()+corfc->get_max_distance())) {
+    // if dependence analysis was requested, do it now (coref solver
+    // only works on chunker output, not over complete trees)
+    if (dep) dep->analyze(pending.front());
+    // output results in requested format 
+    WriteResultsDoc(pending.front(), true, doc); 
+
+    pending.pop_front();
+    pendcand.pop_front();
+  }
+}
+
 //---------------------------------------------
 void ProcessLineCoref(const string &text, list<word> &av,
                       list<sentence> &ls,
@@ -583,10 +625,11 @@ void ProcessLineCoref(const string &text, list<word> &av,
     sp->split(av, true, ls);
     // add sentece to paragraph
     par.insert(par.end(), ls.begin(), ls.end());  
-    // Add paragraph to document
-    if (not par.empty()) doc.push_back(par);  
+    // analyze paragraph, and output those already solved
+    AnalyzeParagraphCoref(par, doc, false);
     // prepare for next paragraph
     par.clear(); 
+    av.clear(); ls.clear();
   }
   else {
     // tokenize input line into a list of words
@@ -610,29 +653,15 @@ void PostProcessCoref(const string &text, list<word> &av,
   sp->split(av, true, ls);
   // add sentece to paragraph
   par.insert(par.end(), ls.begin(), ls.end());
-  // add paragraph to document.
-  doc.push_back(par);
-  
-  // Analyze each document paragraph with all required analyzers
-  for (document::iterator p=doc.begin(); p!=doc.end(); p++) {
-    morfo->analyze(*p);
-    tagger->analyze(*p);
-    neclass->analyze(*p);
-    parser->analyze(*p);
-  }
-  
-  // solve coreference
-  corfc->analyze(doc);
   
-  // if dependence analysis was requested, do it now (coref solver
-  // only works on chunker output, not over complete trees)
-  if (dep)
-    for (document::iterator p=doc.begin(); p!=doc.end(); p++)
-      dep->analyze(*p);
-  
-  // output results in requested format 
-  for (document::iterator par=doc.begin(); par!=doc.end(); par++) 
-    WriteResultsDoc(*par, true, doc); 
+  // analyze last paragraph, and output all remaining ones
+  AnalyzeParagraphCoref(par, doc, true);
+
+  // prepare for next document
+  par.clear();
+  av.clear(); ls.clear();
+  doc = document();
+  corfst = coref::state();
 }
 
 //---------------------------------------------
@@ -851,6 +880,9 @@ int main (int argc, char **argv) {
       AnalyzeSentences(ls);
       WriteResults(ls,true);
     }
+
+    // next document does not use this one as context for sense disambiguation
+    if (dsbws) dsbws->clear_context();
     
     #ifdef SERVER
       cerr<<"SERVER: client ended. Closing connection."<<endl;
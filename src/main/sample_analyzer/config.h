@@ -66,6 +66,11 @@
 #define FORCE_TAGGER 1
 #define FORCE_RETOK  2
 
+// codes for UKB warm start
+#define WARM_NONE     0
+#define WARM_STATIC   1
+#define WARM_PREVIOUS 2
+
 using namespace std;
 
 ////////////////////////////////////////////////////////////////
@@ -127,6 +132,11 @@ class config {
     char *UKB_DictFile;
     int UKB_MaxIter;
     double UKB_Epsilon;
+    int UKB_Threads;
+    double UKB_PushEpsilon;
+    int UKB_WarmStart;
+    int UKB_StableIter;
+    int UKB_Window;
 
     /// Tagger options
     char * TAGGER_HMMFile;
@@ -153,7 +163,7 @@ class config {
       register int ret;
       int help;
       // Auxiliary for string translation
-      char *InputF, *OutputF, *Ner, *Tagger, *SenseAnot, *Force;
+      char *InputF, *OutputF, *Ner, *Tagger, *SenseAnot, *Force, *UKBWarm;
       // Auxiliary for boolean handling
       int train, utf, flush,noflush, afx,noafx,   loc,noloc,   numb,nonumb,
           punt,nopunt,   date,nodate,   quant,noquant,  dict,nodict,   prob,noprob,
@@ -234,6 +244,11 @@ class config {
 	{"fukbdic", 'V',  "UKBDictionary",           CFG_STR,  (void *) &UKB_DictFile, 0},
 	{"ukbeps",  '\0', "UKBEpsilon",              CFG_DOUBLE,(void *) &UKB_Epsilon, 0},
 	{"ukbiter", '\0', "UKBMaxIter",              CFG_INT,  (void *) &UKB_MaxIter, 0},
+	{"ukbthreads", '\0', "UKBThreads",           CFG_INT,  (void *) &UKB_Threads, 0},
+	{"ukbpush", '\0', "UKBPushEpsilon",          CFG_DOUBLE,(void *) &UKB_PushEpsilon, 0},
+	{"ukbwarm", '\0', "UKBWarmStart",            CFG_STR,  (void *) &UKBWarm, 0},
+	{"ukbstable", '\0', "UKBStableIter",         CFG_INT,  (void *) &UKB_StableIter, 0},
+	{"ukbwindow", '\0', "UKBWindow",             CFG_INT,  (void *) &UKB_Window, 0},
 	{"dup",     '\0', NULL,                      CFG_BOOL, (void *) &dup, 0},
 	{"nodup",   '\0', NULL,                      CFG_BOOL, (void *) &nodup, 0},
 	{NULL,      '\0', "DuplicateAnalysis",       CFG_STR,  (void *) &cf_dup, 0},
@@ -267,7 +282,7 @@ class config {
       }
       
       // init auxiliary variables
-      InputF=NULL; OutputF=NULL;  Ner=NULL; Tagger=NULL; SenseAnot=NULL; Force=NULL;
+      InputF=NULL; OutputF=NULL;  Ner=NULL; Tagger=NULL; SenseAnot=NULL; Force=NULL; UKBWarm=NULL;
       train=false; utf=false;
       flush=false; noflush=false; afx=false;   noafx=false; 
       loc=false;   noloc=false;   numb=false;   nonumb=false;   punt=false; nopunt=false;
@@ -302,7 +317,8 @@ class config {
       SENSE_SenseAnnotation=NONE; SENSE_SenseFile=NULL; 
       SENSE_DuplicateAnalysis=false; 
       UKB_BinFile=NULL; UKB_DictFile=NULL;
-      UKB_MaxIter=0; UKB_Epsilon=0;
+      UKB_MaxIter=0; UKB_Epsilon=0; UKB_Threads=1; UKB_PushEpsilon=0;
+      UKB_WarmStart=WARM_NONE; UKB_StableIter=0; UKB_Window=0;
       TAGGER_which=0; TAGGER_HMMFile=NULL; TAGGER_RelaxFile=NULL; 
       TAGGER_RelaxMaxIter=0; TAGGER_RelaxScaleFactor=0.0; TAGGER_RelaxEpsilon=0.0;
       TAGGER_Retokenize=0; TAGGER_ForceSelect=0;
@@ -450,6 +466,13 @@ class config {
       else if (s=="mfs") SENSE_SenseAnnotation = MFS;
       else if (s=="ukb") SENSE_SenseAnnotation = UKB;
       else WARNING("Invalid sense annotation option '"+s+"'. Using default.");
+
+      // translate UKB warm start string to more useful integer values.
+      s = (UKBWarm==NULL ? "none" : string(UKBWarm));
+      if (s=="none" || s=="no") UKB_WarmStart = WARM_NONE;
+      else if (s=="static") UKB_WarmStart = WARM_STATIC;
+      else if (s=="previous") UKB_WarmStart = WARM_PREVIOUS;
+      else WARNING("Invalid UKB warm start option '"+s+"'. Using default.");
     }
 
  private:
@@ -538,6 +561,11 @@ class config {
       cout<<"--fukbrel,-U filename  Compiled relation file for UKB"<<endl;
       cout<<"--ukbeps float         Convergence epsilon for UKB"<<endl;
       cout<<"--ukbiter iter         Maximum iterations for UKB"<<endl;
+      cout<<"--ukbthreads int       Threads used by UKB PageRank (needs OpenMP support)"<<endl;
+      cout<<"--ukbpush float        Residual bound for approximate UKB by local push (0: exact PageRank)"<<endl;
+      cout<<"--ukbwarm string       Initial UKB PageRank ranks (none,static,previous)"<<endl;
+      cout<<"--ukbstable int        Stop UKB PageRank when target synset order is stable for int iterations (0: no)"<<endl;
+      cout<<"--ukbwindow int        Disambiguate each sentence with int sentences of context at each side (0: whole input chunk)"<<endl;
       cout<<"--dup, --nodup         Whether to duplicate analysis for each different sense"<<endl;
       cout<<"--fpunct,-F filename   Punctuation symbols file"<<endl;
       cout<<"--tag,-t string        Tagging alogrithm to use (hmm, relax)"<<endl;
@@ -0,0 +1,123 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2004   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////
+///  Load the AdaBoost models shipped in data/ with compiled_adaboost,
+/// with and without the weak rule type line, and check that single 
+/// and batched classification give the same weights as evaluating 
+/// the trees straight from the file.
+//////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <set>
+#include <cmath>
+
+#include "freeling/compiled_adaboost.h"
+
+#ifndef DATADIR
+#define DATADIR "../../data"
+#endif
+
+using namespace std;
+
+/// Evaluate a tree straight from the file, adding to 'pred' the weights 
+/// of the leaf reached if 'sel' is true. Both subtrees are always read.
+void eval_tree(istream &fin, const set<int> &feats, bool sel, vector<double> &pred) {
+  string tok;
+  fin>>tok;
+  if (tok=="+") {
+    int f;
+    fin>>f;
+    bool present = (feats.find(f)!=feats.end());
+    eval_tree(fin,feats,sel and not present,pred);
+    eval_tree(fin,feats,sel and present,pred);
+  }
+  else {
+    for (size_t l=0; l<pred.size(); l++) {
+      double w;
+      fin>>w;
+      if (sel) pred[l]+=w;
+    }
+  }
+}
+
+/// Compute label weights reading the model file, without any index.
+vector<double> eval_model(const string &fname, const set<int> &feats, int nlab) {
+  vector<double> pred(nlab,0.0);
+  ifstream fin(fname.c_str());
+  string line,tok;
+  getline(fin,line);
+  while (fin>>tok) 
+    if (tok=="---") eval_tree(fin,feats,true,pred);
+  return pred;
+}
+
+int check_model(const string &fname, int nlab) {
+  int err=0;
+
+  compiled_adaboost model(fname);
+  if (model.get_nlabels()!=nlab) {
+    cerr<<fname<<": expected "<<nlab<<" labels, got "<<model.get_nlabels()<<endl;
+    return 1;
+  }
+
+  // a few examples: no features, some features tested by the first 
+  // trees of both models, and a feature not in the model.
+  int offs[]={0,0,3,5};
+  int feats[]={147,3645,19781, 3646,999999999};
+  int n=3;
+
+  vector<double> batch(n*nlab), single(nlab);
+  compiled_adaboost::workspace ws;
+  model.classify(n, offs, feats, &batch[0], ws);
+
+  for (int i=0; i<n; i++) {
+    set<int> ex(feats+offs[i],feats+offs[i+1]);
+    model.classify(ex,&single[0]);
+    vector<double> ref=eval_model(fname,ex,nlab);
+    for (int l=0; l<nlab; l++) {
+      if (fabs(ref[l]-single[l])>1e-6 or fabs(ref[l]-batch[i*nlab+l])>1e-6) {
+        cerr<<fname<<": example "<<i<<" label "<<l<<": expected "<<ref[l]<<", got "<<single[l]<<" (batched "<<batch[i*nlab+l]<<")"<<endl;
+        err=1;
+      }
+    }
+  }
+
+  if (!err) cout<<fname<<": OK"<<endl;
+  return err;
+}
+
+int main() {
+  int err=0;
+  // as model has no "mlDTree" line, es model has it.
+  err |= check_model(string(DATADIR)+"/as/nec/nec.abm",3);
+  err |= check_model(string(DATADIR)+"/es/nec/nec.abm",3);
+  return err;
+}
@@ -0,0 +1,83 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2004   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////
+///  Check the stopping conditions of the CSR pageRank used by UKB:
+/// with no iterations and no threshold it must either stop on a 
+/// stable rank order, or refuse to run (it would never end).
+//////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <vector>
+#include <stdexcept>
+
+#include "kbGraph.h"
+#include "prank.h"
+
+using namespace std;
+using namespace ukb::prank;
+
+int main() {
+  int err=0;
+
+  // 0 -> 1 -> 2 -> 0, and 0 -> 2
+  const unsigned int offsets[]={0,1,2,4};
+  const unsigned int sources[]={2,0,1,0};
+  const float out_coef[]={0.5,1.0,1.0};
+  const float coefs[]={1.0,0.5,1.0,0.5};
+  csr_graph<unsigned int> g;
+  g.N=3; g.offsets=offsets; g.sources=sources; g.coefs=coefs;
+  const float ppv[]={1.0,0.0,0.0};
+  vector<float> r1(3), r2(3);
+
+  // no iterations, no threshold, and a watch with no groups: nothing 
+  // would stop the loop, so it must throw.
+  rank_watch<unsigned int> empty;
+  empty.n=0; empty.offsets=offsets; empty.V=sources; empty.patience=3;
+  try {
+    do_pageRank_csr(g, 3, ppv, &r1[0], &r2[0], 0, 0.0f, 0.85f, out_coef, 1, false, &empty);
+    cerr<<"empty watch: pageRank did not refuse to run"<<endl;
+    err=1;
+  }
+  catch (runtime_error &e) {}
+
+  // same with a real watch: stops when the order of the group is stable
+  const unsigned int woffs[]={0,3};
+  const unsigned int wV[]={0,1,2};
+  rank_watch<unsigned int> watch;
+  watch.n=1; watch.offsets=woffs; watch.V=wV; watch.patience=3;
+  do_pageRank_csr(g, 3, ppv, &r1[0], &r2[0], 0, 0.0f, 0.85f, out_coef, 1, false, &watch);
+  float sum=r1[0]+r1[1]+r1[2];
+  if (sum<0.99 or sum>1.01 or not (r1[0]>r1[2] and r1[2]>r1[1])) {
+    cerr<<"watched pageRank gave "<<r1[0]<<" "<<r1[1]<<" "<<r1[2]<<endl;
+    err=1;
+  }
+
+  if (!err) cout<<"pageRank stopping conditions: OK"<<endl;
+  return err;
+}
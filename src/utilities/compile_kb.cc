@@ -4,6 +4,7 @@
 #include "configFile.h"
 #include "fileElem.h"
 #include "kbGraph.h"
+#include "kbImage.h"
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -142,8 +143,10 @@ int main(int argc, char *argv[]) {
   bool opt_iquery = false;
   bool opt_dump = false;
   bool opt_dang = false;
+  bool opt_verify = false;
 
   string fullname_out("kb_wnet.bin");
+  string image_dict;
   vector<string> kb_files;
   string query_vertex;
 
@@ -165,6 +168,8 @@ int main(int argc, char *argv[]) {
     "compile_kb [-o output.bin] [-f \"src1, src2\"] kb_file.txt kb_file.txt ... -> Create a KB image reading relations textfiles.\n"
     "compile_kb -i kb_file.bin -> Get info of a previously compiled KB.\n"
     "compile_kb -q concept-id kb_file.bin -> Query a node on a previously compiled KB.\n"
+    "compile_kb -m dict_file [-o output.img] kb_file.txt ... -> Create a memory mapped image of the KB and the dictionary.\n"
+    "compile_kb --verify image.img -> Check the contents of a memory mapped image.\n"
     "Options:";
 
   using namespace boost::program_options;
@@ -180,6 +185,8 @@ int main(int argc, char *argv[]) {
     ("dump", "Dump a serialized graph. Warning: very verbose!.")
     ("nodangling", "Recursively remove all dangling nodes from graph.")
     ("output,o", value<string>(), "Output file name.")
+    ("image,m", value<string>(), "Add the words of given dictionary and write a memory mapped image of KB and dictionary.")
+    ("verify", "Check the contents of a memory mapped image.")
     ("query,q", value<string>(), "Given a vertex name, display its coocurrences.")
     ("iquery,Q", "Interactively query graph.")
     ("undirected,U", "Force undirected graph.")
@@ -233,6 +240,10 @@ int main(int argc, char *argv[]) {
       opt_iquery = true;
     }
 
+    if (vm.count("verify")) {
+      opt_verify = true;
+    }
+
     if (vm.count("nodangling")) {
       opt_dang = true;
     }
@@ -266,6 +277,10 @@ int main(int argc, char *argv[]) {
      if (vm.count("output")) {
        fullname_out = vm["output"].as<string>();
      }
+
+    if (vm.count("image")) {
+      image_dict = vm["image"].as<string>();
+    }
   }
   catch(std::exception& e) {
     cerr << e.what() << "\n";
@@ -284,6 +299,18 @@ int main(int argc, char *argv[]) {
     return 0;
   }
 
+  if (opt_verify) {
+    try {
+      KbImage img(kb_files[0]);
+      img.verify();
+      cout << kb_files[0] << ": valid image, " << img.size() << " vertices" << endl;
+    } catch (std::exception & e) {
+      cerr << e.what() << endl;
+      return 1;
+    }
+    return 0;
+  }
+
   if (opt_Info) {
     Kb::create_from_binfile(kb_files[0]);
 
@@ -339,6 +366,17 @@ int main(int argc, char *argv[]) {
     Kb::instance().add_from_txt(kb_files[i], src_allowed);
   }
 
+  if (image_dict.size()) {
+    if (glVars::verbose)
+      cerr << "Writing image file: "<< fullname_out<< endl;
+    WDict dict(image_dict);
+    KbImage::write_image(Kb::instance(), dict, fullname_out);
+    // loading only checks the layout, so check the contents here
+    KbImage img(fullname_out);
+    img.verify();
+    return 0;
+  }
+
   if (glVars::verbose)
     cerr << "Writing binary file: "<< fullname_out<< endl;
   Kb::instance().add_comment(cmdline);
@@ -40,12 +40,25 @@
 //	The paramaters are the 3 necesary files soundChangeRules
 //	soundChangeDicFile and sampaFile
 //
+//	If option --sounds is given before them, each word in the
+//	data is followed by its phonetic transcription (word|sound)
+//	so the corrector does not need to compute it.
+//
+//	With option --deletions k (and no files) the output is
+//	instead a deletion index for the corrector:
+//
+//      key1(word with up to k chars deleted)  data1(words that match) 
+//
+//	Words with up to k chars are stored under key <empty>, and
+//	key <depth> holds k.
+//
 ////////////////////////////////////////////////////////////////
 
 #include <iostream>
 #include <string>
 #include <cstdlib>
 #include "freeling/phonetics.h"
+#include "freeling/similarity.h"
 #include "fries/util.h"
 
 
@@ -55,7 +68,14 @@ using namespace std;
 int main(int argc, char *argv[]){
 	
 	
-	if (!argc==3) { cout << "You need to specify the 3 necesary files: soundChangeRules, soundChangeDicFile and sampaFile" << endl; exit(0);}
+	int arg=1;
+	bool sounds=false;
+	int deletions=0;
+	if (argc>1 and string(argv[1])=="--sounds") { sounds=true; arg++; }
+	else if (argc>2 and string(argv[1])=="--deletions") { deletions=atoi(argv[2]); arg+=2; }
+
+	if (deletions>0 and argc-arg!=0) { cout << "No files are needed to build a deletion index" << endl; exit(0);}
+	if (deletions==0 and argc-arg!=3) { cout << "You need to specify the 3 necesary files: soundChangeRules, soundChangeDicFile and sampaFile" << endl; exit(0);}
 	
 	string line;
 	vector<string> words;
@@ -67,24 +87,43 @@ int main(int argc, char *argv[]){
 		words.push_back(vs.at(0));
 	}
 	
+	map<string,string> bd;
+
+	if (deletions>0) {
+		// index every word under each string obtained deleting up to k chars
+		set<string> seen;
+		for( vector<string>::iterator iter = words.begin(); iter != words.end(); iter++ ) {
+			if (!seen.insert(*iter).second) continue;
+			set<string> dels;
+			similarity::getDeletions(*iter,deletions,dels);
+			for (set<string>::iterator d=dels.begin(); d!=dels.end(); d++)
+				bd[d->empty() ? similarity::EMPTY_DELETION : *d]+=","+(*iter);
+		}
+		bd[similarity::DELETION_DEPTH]=","+util::int2string(deletions);
+
+		for( map<string,string>::iterator iter=bd.begin(); iter!=bd.end(); ++iter )
+			cout << iter->first << " " << iter->second.substr(1) << endl;
+		exit(0);
+	}
+	
 			
-	string soundChangeRules=argv[1];
-	string soundChangeDicFile=argv[2];
-	string sampaFile=argv[3];
+	string soundChangeRules=argv[arg];
+	string soundChangeDicFile=argv[arg+1];
+	string sampaFile=argv[arg+2];
 	
-	phonetics ph(soundChangeRules,soundChangeDicFile,sampaFile,false);
+	// each word is transcribed only once, no cache needed
+	phonetics ph(soundChangeRules,soundChangeDicFile,sampaFile,false,0);
 	
 	// we translate every word for his phonetic sound
 	
-	 map<string,string> bd;
-	
 	
 	for( vector<string>::iterator iter = words.begin(); iter != words.end(); iter++ ) {
 		string word=*iter;
-		string sound=ph.getSound(word);
-		sound=util::eliminateChars(sound,"aeiou@AEIOU");
+		string phon=ph.getSound(word);
+		string sound=util::eliminateChars(phon,"aeiou@AEIOU");
 		if (sound.size()==0) { sound="aeiou";}
-		bd[sound]+=","+word;
+		if (sounds) bd[sound]+=","+word+"|"+phon;
+		else bd[sound]+=","+word;
 	}
 	
 	